@@ -0,0 +1,77 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "cpx.h"
+#include "uint256.h"
+
+/*
+ * the state ui.c keeps, that the app core reads and writes.
+ * ui.c itself drives the screens of the device, and isn't part of the benchmark.
+ */
+enum UI_STATE uiState;
+enum REVIEW_TYPE review_type;
+ux_state_t ux;
+unsigned char hashTainted;
+unsigned char publicKeyNeedsRefresh;
+cx_sha256_t hash;
+unsigned char tx_hash[SHA256_HASH_LEN];
+unsigned int curr_scr_ix;
+unsigned int max_scr_ix;
+unsigned char raw_tx[MAX_TX_RAW_LENGTH];
+unsigned int raw_tx_ix;
+unsigned int raw_tx_len;
+unsigned int raw_tx_body_len;
+unsigned char sign_path_count;
+char curr_tx_desc[TX_DESC_PAGE_LINES][MAX_TX_TEXT_WIDTH];
+char current_public_key[MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
+
+/** the summary of the transaction, read by the operations on its value. */
+static tx_summary_t summary;
+
+/** the value of the transaction as text, long enough for any 32 byte number. */
+static char value_text[80];
+
+/** sets up the transaction of len bytes, that the emulator wrote to raw_tx, to be read from its start. */
+static void load_tx(unsigned int len) {
+	raw_tx_ix = 0;
+	raw_tx_len = len;
+	raw_tx_body_len = len;
+	sign_path_count = 1;
+	review_type = REVIEW_TX;
+}
+
+/** parses the transaction into its screens, and renders the first one, as on a sign request. returns the number of screens. */
+unsigned int bench_parse(unsigned int len) {
+	load_tx(len);
+	display_tx_desc();
+	return max_scr_ix;
+}
+
+/** renders each screen of the transaction parsed by bench_parse, and each of their pages, as the user scrolls. returns the number of pages. */
+unsigned int bench_render(void) {
+	unsigned int page_total = 0;
+	for (unsigned int scr_ix = 0; scr_ix < max_scr_ix; scr_ix++) {
+		const unsigned int page_count = load_tx_desc_screen(scr_ix);
+		for (unsigned int page_ix = 0; page_ix < page_count; page_ix++) {
+			load_tx_desc_page(page_ix);
+		}
+		page_total += page_count;
+	}
+	return page_total;
+}
+
+/** parses the transaction into its summary, as on a batch or policy request. returns 1 for a transfer, 0 otherwise. */
+unsigned int bench_summary(unsigned int len) {
+	load_tx(len);
+	clear256(&summary.value);
+	clear256(&summary.fee);
+	return parse_tx_summary(&summary) ? 1 : 0;
+}
+
+/** formats the value of the summary in base 10, one divmod256_small per digit. returns the number of digits. */
+unsigned int bench_tostring256(void) {
+	if (!tostring256(&summary.value, 10, value_text, sizeof(value_text))) {
+		return 0;
+	}
+	return strlen(value_text);
+}
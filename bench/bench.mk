@@ -0,0 +1,31 @@
+# Instruction counts of parsing and formatting transactions, included by the Makefile.
+#
+# Builds the app core with the flags of the app, against the headers of stub/include instead of the SDK,
+# then counts the instructions of each operation of bench/bench.c on each transaction of bench/corpus.txt
+# with bench/run_bench.py, under an emulator. The build fails if a count is over bench/baseline.txt by more than
+# BENCH_TOLERANCE percent, a count not in it is only warned about. make bench_baseline writes the counts to bench/baseline.txt, to commit with a change
+# that is meant to change them.
+
+BENCH_TOLERANCE = 0
+
+.PHONY: bench bench_baseline
+
+BENCH_SOURCES = bench/bench.c bench/syscalls.c
+BENCH_SOURCES += $(addprefix src/,cpx.c uint256.c paginator.c scratch.c allow_list.c batch.c policy.c message.c keys.c audit_log.c call_counts.c trace.c)
+BENCH_OBJECTS = $(patsubst %.c,bench/obj/%.o,$(BENCH_SOURCES))
+
+# the target is set by the headers of the SDK on the device, here by the flags.
+BENCH_CFLAGS = -Istub/include -Isrc -isystem $(shell $(LD) -print-sysroot)/include $(CFLAGS) -D$(TARGET_NAME) $(addprefix -D,$(DEFINES))
+
+bench/obj/%.o: %.c $(wildcard src/*.h stub/include/*.h)
+	@mkdir -p $(dir $@)
+	$(CC) -c $(BENCH_CFLAGS) -o $@ $<
+
+bench/obj/bench.elf: $(BENCH_OBJECTS) bench/bench.ld
+	$(LD) $(filter -mcpu=% -mthumb,$(CFLAGS)) -nostartfiles --specs=nano.specs --specs=nosys.specs -T bench/bench.ld -o $@ $(BENCH_OBJECTS) -lc -lgcc
+
+bench: bench/obj/bench.elf
+	python3 bench/run_bench.py bench/obj/bench.elf bench/corpus.txt bench/baseline.txt $(BENCH_TOLERANCE)
+
+bench_baseline: bench/obj/bench.elf
+	python3 bench/run_bench.py bench/obj/bench.elf bench/corpus.txt bench/baseline.txt --update
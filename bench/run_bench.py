@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""
+Instruction counts of parsing and formatting transactions, on the ARM build of the app core.
+
+Runs the operations of bench.c on each transaction of the corpus, in a user mode
+Cortex-M emulator (unicorn), and counts the instructions each one runs. The
+system calls are run here instead, they are the code of the OS on the device,
+so they count as no instructions.
+
+Writes the count of each transaction and operation, and compares it with the
+baseline. Exits with an error if a count is over its baseline by more than the
+tolerance, in percent. A count with no baseline yet is not checked, it is
+warned about with the number of such counts, until the baseline is written
+and committed. With --update, writes the counts to the baseline instead.
+
+usage: run_bench.py <elf> <corpus> <baseline> [<tolerance>] [--update]
+
+needs: pip3 install unicorn pyelftools
+"""
+
+import hashlib
+import sys
+
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+from unicorn import Uc, UcError, UC_ARCH_ARM, UC_MODE_THUMB, UC_MODE_MCLASS, UC_HOOK_CODE
+from unicorn.arm_const import UC_ARM_REG_R0, UC_ARM_REG_R1, UC_ARM_REG_R2, UC_ARM_REG_R3, UC_ARM_REG_SP, UC_ARM_REG_LR, \
+	UC_ARM_REG_PC
+
+# the memory of bench.ld, and a stack of our own.
+FLASH = (0x08000000, 0x100000)
+RAM = (0x20000000, 0x40000)
+STACK = (0x30000000, 0x10000)
+
+# the operations return here, a page of their own, where the emulator stops.
+RETURN = 0x40000000
+
+# CX_LAST in stub/include/cx.h.
+CX_LAST = 1
+
+# the operations of bench.c, in the order they run on each transaction, and if they take its length.
+OPERATIONS = [
+	('parse', 'bench_parse', True),
+	('render', 'bench_render', False),
+	('summary', 'bench_summary', True),
+	('tostring256', 'bench_tostring256', False),
+]
+
+
+class Thrown(Exception):
+	pass
+
+
+class Bench:
+	def __init__(self, elf_path):
+		self.uc = Uc(UC_ARCH_ARM, UC_MODE_THUMB | UC_MODE_MCLASS)
+		for base, size in (FLASH, RAM, STACK, (RETURN, 0x1000)):
+			self.uc.mem_map(base, size)
+		with open(elf_path, 'rb') as elf_file:
+			elf = ELFFile(elf_file)
+			for segment in elf.iter_segments():
+				if segment['p_type'] == 'PT_LOAD' and segment['p_filesz'] > 0:
+					self.uc.mem_write(segment['p_paddr'], segment.data())
+			self.symbols = {}
+			for section in elf.iter_sections():
+				if isinstance(section, SymbolTableSection):
+					for symbol in section.iter_symbols():
+						self.symbols[symbol.name] = symbol['st_value'] & ~1
+		# the system calls run here, by the address of their placeholder in syscalls.c.
+		self.syscalls = {}
+		for name, handler in (('os_longjmp', self.os_longjmp), ('nvm_write', self.nvm_write), ('cx_sha256_init', self.cx_sha256_init),
+				('cx_ripemd160_init', self.cx_ripemd160_init), ('cx_hash', self.cx_hash)):
+			if name in self.symbols:
+				self.syscalls[self.symbols[name]] = handler
+		self.hashes = {}
+		self.count = 0
+		self.thrown = None
+		self.uc.hook_add(UC_HOOK_CODE, self.on_instruction)
+
+	def arg(self, index):
+		if index < 4:
+			return self.uc.reg_read((UC_ARM_REG_R0, UC_ARM_REG_R1, UC_ARM_REG_R2, UC_ARM_REG_R3)[index])
+		sp = self.uc.reg_read(UC_ARM_REG_SP)
+		return int.from_bytes(self.uc.mem_read(sp + 4 * (index - 4), 4), 'little')
+
+	def on_instruction(self, uc, address, size, data):
+		handler = self.syscalls.get(address)
+		if handler is None:
+			self.count += 1
+			return
+		result = handler()
+		if self.thrown is not None:
+			uc.emu_stop()
+			return
+		uc.reg_write(UC_ARM_REG_R0, result & 0xFFFFFFFF)
+		uc.reg_write(UC_ARM_REG_PC, uc.reg_read(UC_ARM_REG_LR) | 1)
+
+	def os_longjmp(self):
+		self.thrown = self.arg(0)
+		return 0
+
+	def nvm_write(self):
+		self.uc.mem_write(self.arg(0), bytes(self.uc.mem_read(self.arg(1), self.arg(2))))
+		return 0
+
+	def cx_sha256_init(self):
+		self.hashes[self.arg(0)] = hashlib.sha256()
+		return 0
+
+	def cx_ripemd160_init(self):
+		self.hashes[self.arg(0)] = hashlib.new('ripemd160')
+		return 0
+
+	def cx_hash(self):
+		context, mode, data, length, out = self.arg(0), self.arg(1), self.arg(2), self.arg(3), self.arg(4)
+		hash = self.hashes[context]
+		hash.update(bytes(self.uc.mem_read(data, length)))
+		if not (mode & CX_LAST):
+			return 0
+		digest = hash.digest()
+		self.uc.mem_write(out, digest)
+		self.hashes[context] = hashlib.new(hash.name)
+		return len(digest)
+
+	def call(self, function, *args):
+		for register, value in zip((UC_ARM_REG_R0, UC_ARM_REG_R1, UC_ARM_REG_R2, UC_ARM_REG_R3), args):
+			self.uc.reg_write(register, value)
+		self.uc.reg_write(UC_ARM_REG_SP, STACK[0] + STACK[1])
+		self.uc.reg_write(UC_ARM_REG_LR, RETURN | 1)
+		self.count = 0
+		self.thrown = None
+		try:
+			self.uc.emu_start(self.symbols[function] | 1, RETURN)
+		except UcError as error:
+			raise Thrown('%s stopped at %08x: %s' % (function, self.uc.reg_read(UC_ARM_REG_PC), error))
+		if self.thrown is not None:
+			raise Thrown('%s threw %04X' % (function, self.thrown))
+		return self.count
+
+	def run(self, tx):
+		self.uc.mem_write(self.symbols['raw_tx'], tx)
+		counts = []
+		for operation, function, takes_length in OPERATIONS:
+			counts.append((operation, self.call(function, len(tx)) if takes_length else self.call(function)))
+		return counts
+
+
+def read_corpus(path):
+	corpus = []
+	with open(path) as corpus_file:
+		for line in corpus_file:
+			line = line.strip()
+			if line and not line.startswith('#'):
+				name, tx = line.split()
+				corpus.append((name, bytes.fromhex(tx)))
+	return corpus
+
+
+def read_baseline(path):
+	baseline = {}
+	try:
+		with open(path) as baseline_file:
+			for line in baseline_file:
+				line = line.strip()
+				if line and not line.startswith('#'):
+					name, operation, count = line.split()
+					baseline[(name, operation)] = int(count)
+	except FileNotFoundError:
+		pass
+	return baseline
+
+
+def main():
+	args = [arg for arg in sys.argv[1:] if arg != '--update']
+	update = '--update' in sys.argv
+	if len(args) < 3:
+		sys.exit(__doc__)
+	elf, corpus_path, baseline_path = args[0], args[1], args[2]
+	tolerance = float(args[3]) if len(args) > 3 else 0.0
+
+	bench = Bench(elf)
+	baseline = read_baseline(baseline_path)
+	counts = []
+	failures = []
+	missing = 0
+	print('%-20s %-12s %10s %10s %8s' % ('transaction', 'operation', 'count', 'baseline', 'change'))
+	for name, tx in read_corpus(corpus_path):
+		try:
+			tx_counts = bench.run(tx)
+		except Thrown as error:
+			sys.exit('run_bench.py: %s: %s' % (name, error))
+		for operation, count in tx_counts:
+			counts.append((name, operation, count))
+			before = baseline.get((name, operation))
+			if before is None:
+				print('%-20s %-12s %10d %10s %8s' % (name, operation, count, '-', 'new'))
+				missing += 1
+				continue
+			change = 100.0 * (count - before) / before if before else 0.0
+			print('%-20s %-12s %10d %10d %+7.2f%%' % (name, operation, count, before, change))
+			if count > before * (1 + tolerance / 100):
+				failures.append('%s %s runs %d instructions, %+.2f%% over the baseline of %d' % (name, operation, count, change, before))
+
+	if update:
+		with open(baseline_path, 'w') as baseline_file:
+			baseline_file.write('# instructions of each transaction of corpus.txt and operation of bench.c, written by run_bench.py --update.\n')
+			for name, operation, count in counts:
+				baseline_file.write('%s %s %d\n' % (name, operation, count))
+		print('run_bench.py: wrote ' + baseline_path)
+		return
+	if missing:
+		sys.stderr.write('run_bench.py: warning: %d of %d counts have no baseline and are not checked, write it with --update and commit it\n' % (missing, len(counts)))
+	if failures:
+		sys.exit('run_bench.py: ' + '\nrun_bench.py: '.join(failures))
+
+
+if __name__ == '__main__':
+	main()
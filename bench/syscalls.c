@@ -0,0 +1,84 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "os.h"
+#include "cx.h"
+
+/*
+ * the system calls of the app core, in the benchmark.
+ * run_bench.py runs each of them itself when it is called, and returns to the caller without running its code,
+ * as the code of a system call is the one of the OS on the device, not of the app.
+ * a system call it doesn't know stops the benchmark at the breakpoint.
+ */
+
+/** stops the emulator, only reached for a system call run_bench.py doesn't know. */
+#define NOT_EMULATED() __asm volatile("bkpt #0")
+
+void os_longjmp(unsigned int exception) {
+	NOT_EMULATED();
+	for (;;) {
+	}
+}
+
+void nvm_write(void * dst, void * src, unsigned int len) {
+	NOT_EMULATED();
+}
+
+void os_perso_derive_node_bip32(int curve, const unsigned int * path, unsigned int path_len, unsigned char * private_key, unsigned char * chain) {
+	NOT_EMULATED();
+}
+
+int cx_sha256_init(cx_sha256_t * hash) {
+	NOT_EMULATED();
+	return 0;
+}
+
+int cx_ripemd160_init(cx_ripemd160_t * hash) {
+	NOT_EMULATED();
+	return 0;
+}
+
+int cx_hash(cx_hash_t * hash, int mode, const unsigned char * in, unsigned int len, unsigned char * out, unsigned int out_len) {
+	NOT_EMULATED();
+	return 0;
+}
+
+int cx_hmac_sha512(const unsigned char * key, unsigned int key_len, const unsigned char * in, unsigned int len, unsigned char * mac, unsigned int mac_len) {
+	NOT_EMULATED();
+	return 0;
+}
+
+int cx_ecdsa_init_private_key(int curve, const unsigned char * raw_key, unsigned int key_len, cx_ecfp_private_key_t * private_key) {
+	NOT_EMULATED();
+	return 0;
+}
+
+int cx_ecdsa_init_public_key(int curve, const unsigned char * raw_key, unsigned int key_len, cx_ecfp_public_key_t * public_key) {
+	NOT_EMULATED();
+	return 0;
+}
+
+int cx_ecfp_generate_pair(int curve, cx_ecfp_public_key_t * public_key, cx_ecfp_private_key_t * private_key, int keep_private) {
+	NOT_EMULATED();
+	return 0;
+}
+
+int cx_ecdsa_sign(const cx_ecfp_private_key_t * private_key, int mode, int hash_id, const unsigned char * hash, unsigned int hash_len,
+		unsigned char * sig, unsigned int sig_len, unsigned int * info) {
+	NOT_EMULATED();
+	return 0;
+}
+
+void cx_math_addm(unsigned char * r, const unsigned char * a, const unsigned char * b, const unsigned char * m, unsigned int len) {
+	NOT_EMULATED();
+}
+
+int cx_math_cmp(const unsigned char * a, const unsigned char * b, unsigned int len) {
+	NOT_EMULATED();
+	return 0;
+}
+
+int cx_math_is_zero(const unsigned char * a, unsigned int len) {
+	NOT_EMULATED();
+	return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "allow_list.h"
+
+/** a known recipient, a slot that was never written is all zeros. */
+typedef struct {
+	unsigned char used;
+	unsigned char script_hash[SCRIPT_HASH_LEN];
+	char label[ALLOW_LABEL_LEN];
+} allow_entry_t;
+
+/**
+ * the known recipients, in NVRAM, as an open addressing hash table with linear probing.
+ * script hashes are already uniformly distributed, so their first bytes are the index of their first slot.
+ */
+typedef struct {
+	allow_entry_t entries[ALLOW_LIST_SLOTS];
+} allow_list_t;
+
+/** the allow-list, in NVRAM. */
+const allow_list_t N_allow_list_real;
+
+/** the allow-list, at its address in the loaded app. */
+#define N_allow_list (*(volatile allow_list_t *) PIC(&N_allow_list_real))
+
+/** the recipient being reviewed. */
+static allow_entry_t request;
+
+/** returns the first slot to look for the script hash in. */
+static unsigned int first_slot(const unsigned char * script_hash) {
+	return ((script_hash[0] << 8) | script_hash[1]) & (ALLOW_LIST_SLOTS - 1);
+}
+
+/** returns the slot of the script hash, or of the empty slot that ends its probe sequence, or ALLOW_LIST_SLOTS if the table is full. */
+static unsigned int find_slot(const unsigned char * script_hash) {
+	unsigned int slot = first_slot(script_hash);
+	for (unsigned int probe = 0; probe < ALLOW_LIST_SLOTS; probe++) {
+		const allow_entry_t * entry = (const allow_entry_t *) &N_allow_list.entries[slot];
+		if (!entry->used || (os_memcmp(entry->script_hash, script_hash, SCRIPT_HASH_LEN) == 0)) {
+			return slot;
+		}
+		slot = (slot + 1) & (ALLOW_LIST_SLOTS - 1);
+	}
+	return ALLOW_LIST_SLOTS;
+}
+
+void allow_list_load_request(const unsigned char * in, unsigned int in_len) {
+	allow_list_wipe_request();
+	if ((in_len <= SCRIPT_HASH_LEN) || (in_len >= SCRIPT_HASH_LEN + ALLOW_LABEL_LEN)) {
+		THROW(0x6D24);
+	}
+	// the label is displayed, so it can only have characters the font has.
+	for (unsigned int ix = SCRIPT_HASH_LEN; ix < in_len; ix++) {
+		if ((in[ix] < 0x20) || (in[ix] > 0x7E)) {
+			THROW(0x6D24);
+		}
+	}
+
+	// a new recipient takes an empty slot, only while the table stays short of full, checked before the user is asked.
+	const unsigned int slot = find_slot(in);
+	if (slot == ALLOW_LIST_SLOTS) {
+		THROW(0x6D25);
+	}
+	if (!N_allow_list.entries[slot].used) {
+		unsigned int count = 0;
+		for (unsigned int ix = 0; ix < ALLOW_LIST_SLOTS; ix++) {
+			count += N_allow_list.entries[ix].used;
+		}
+		if (count >= MAX_ALLOW_LIST_ENTRIES) {
+			THROW(0x6D25);
+		}
+	}
+
+	request.used = 1;
+	os_memmove(request.script_hash, in, SCRIPT_HASH_LEN);
+	os_memmove(request.label, in + SCRIPT_HASH_LEN, in_len - SCRIPT_HASH_LEN);
+}
+
+void allow_list_approve(void) {
+	nvm_write((void *) &N_allow_list.entries[find_slot(request.script_hash)], &request, sizeof(request));
+	allow_list_wipe_request();
+}
+
+void allow_list_wipe_request(void) {
+	os_memset(&request, 0x00, sizeof(request));
+}
+
+const unsigned char * allow_list_request_script_hash(void) {
+	return request.script_hash;
+}
+
+const char * allow_list_request_label(void) {
+	return request.label;
+}
+
+const char * allow_list_lookup(const unsigned char * script_hash) {
+	const unsigned int slot = find_slot(script_hash);
+	if ((slot == ALLOW_LIST_SLOTS) || !N_allow_list.entries[slot].used) {
+		return NULL;
+	}
+	return (const char *) N_allow_list.entries[slot].label;
+}
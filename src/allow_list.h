@@ -0,0 +1,44 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef ALLOW_LIST_H
+#define ALLOW_LIST_H
+
+#include "os.h"
+#include "cx.h"
+#include <stdbool.h>
+#include "ui.h"
+#include "cpx.h"
+
+/** number of slots of the allow-list in NVRAM, a power of two. */
+#define ALLOW_LIST_SLOTS 256
+
+/** max number of known recipients, the table is kept at most 3/4 full so lookups stay short. */
+#define MAX_ALLOW_LIST_ENTRIES ((ALLOW_LIST_SLOTS * 3) / 4)
+
+/** max length of the label of a known recipient, with the terminating zero. */
+#define ALLOW_LABEL_LEN 11
+
+/**
+ * reads a request to add a known recipient, to be reviewed, throws an error if the list is full.
+ * the request is the script hash of the recipient followed by its label, 1 to ALLOW_LABEL_LEN - 1 printable characters.
+ * adding a recipient that is already known replaces its label.
+ */
+void allow_list_load_request(const unsigned char * in, unsigned int in_len);
+
+/** writes the reviewed recipient to the allow-list in NVRAM. */
+void allow_list_approve(void);
+
+/** forgets the request. */
+void allow_list_wipe_request(void);
+
+/** returns the script hash of the recipient being reviewed. */
+const unsigned char * allow_list_request_script_hash(void);
+
+/** returns the label of the recipient being reviewed. */
+const char * allow_list_request_label(void);
+
+/** returns the label of the script hash if it is a known recipient, otherwise NULL. */
+const char * allow_list_lookup(const unsigned char * script_hash);
+
+#endif // ALLOW_LIST_H
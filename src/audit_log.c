@@ -0,0 +1,203 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "audit_log.h"
+#include "batch.h"
+
+/** a signed transaction, as sent in the response, the counter is 0 in a slot never written. */
+typedef struct {
+	/** increases with each signature, across app restarts, big endian. */
+	unsigned char counter[4];
+	unsigned char tx_hash[SHA256_HASH_LEN];
+	unsigned char to[SCRIPT_HASH_LEN];
+	/** value sent, big endian. */
+	unsigned char value[32];
+} audit_record_t;
+
+/**
+ * a record in NVRAM, followed by a copy of its counter.
+ * the pages are written in order, so if the device loses power between the pages of a record, the copy is still the
+ * counter of the record it replaced, and the record is known to be only in part.
+ */
+typedef struct {
+	audit_record_t record;
+	unsigned char end_counter[4];
+} audit_slot_t;
+
+/**
+ * the records, in NVRAM, as a ring written in order, one page at a time.
+ * slots are not padded, so they straddle pages, and the ring is aligned to the pages and ends on one, so each page of
+ * the ring is written once per turn of the ring, plus once more if the app exits while it is the last, partial one.
+ */
+typedef struct {
+	audit_slot_t slots[AUDIT_LOG_SIZE];
+} audit_log_nvram_t;
+
+/** size of the ring, in bytes. */
+#define AUDIT_LOG_RING_LEN (AUDIT_LOG_SIZE * sizeof(audit_slot_t))
+
+/** number of pages of the ring. */
+#define AUDIT_LOG_RING_PAGES (AUDIT_LOG_RING_LEN / AUDIT_LOG_NVRAM_PAGE)
+
+/** pages kept in RAM, enough for the last partial page and the records of a whole batch, signed before the next tick. */
+#define AUDIT_LOG_BUFFER_PAGES ((AUDIT_LOG_NVRAM_PAGE - 1 + (MAX_BATCH_TX_COUNT * sizeof(audit_slot_t)) + AUDIT_LOG_NVRAM_PAGE - 1) / AUDIT_LOG_NVRAM_PAGE)
+
+/** fails to compile if the ring doesn't end on a page, its last page would be shared with whatever follows it. */
+typedef char audit_log_ring_is_whole_pages[((AUDIT_LOG_RING_LEN % AUDIT_LOG_NVRAM_PAGE) == 0) ? 1 : -1];
+
+/** the log, in NVRAM. */
+const audit_log_nvram_t N_audit_log_real __attribute__((aligned(AUDIT_LOG_NVRAM_PAGE)));
+
+/** the log, at its address in the loaded app. */
+#define N_audit_log (*(volatile audit_log_nvram_t *) PIC(&N_audit_log_real))
+
+/** where the log continues, and the pages not written yet. */
+static struct {
+	/** counter of the next record. */
+	unsigned int next_counter;
+	/** slot of the ring the next record is written to. */
+	unsigned int head;
+	/** page of the ring the first page in RAM is written to. */
+	unsigned int buffer_page;
+	/** bytes in RAM from the start of that page, the slots already on the page come first. */
+	unsigned int buffer_len;
+	unsigned char buffer[AUDIT_LOG_BUFFER_PAGES * AUDIT_LOG_NVRAM_PAGE];
+} audit_log;
+
+/** writes the 4 bytes of number into out, big endian. */
+static void write_u32_be(unsigned char * out, unsigned int number) {
+	out[0] = number >> 24;
+	out[1] = number >> 16;
+	out[2] = number >> 8;
+	out[3] = number;
+}
+
+/** writes the 8 bytes of number into out, big endian. */
+static void write_u64_be(unsigned char * out, uint64_t number) {
+	for (unsigned int ix = 0; ix < 8; ix++) {
+		out[ix] = (unsigned char) (number >> (56 - (8 * ix)));
+	}
+}
+
+/** returns the byte of the ring at offset, from RAM if it is not written yet, or from NVRAM. */
+static unsigned char ring_byte(unsigned int offset) {
+	const unsigned int buffer_ix = (offset + AUDIT_LOG_RING_LEN - (audit_log.buffer_page * AUDIT_LOG_NVRAM_PAGE)) % AUDIT_LOG_RING_LEN;
+	if (buffer_ix < audit_log.buffer_len) {
+		return audit_log.buffer[buffer_ix];
+	}
+	return ((const volatile unsigned char *) &N_audit_log)[offset];
+}
+
+/** reads the big endian counter at offset of the ring. */
+static unsigned int ring_counter(unsigned int offset) {
+	unsigned int counter = 0;
+	for (unsigned int ix = 0; ix < 4; ix++) {
+		counter = (counter << 8) | ring_byte(offset + ix);
+	}
+	return counter;
+}
+
+/** returns the counter of the record in slot, or 0 if it was never written, or only in part before a power off. */
+static unsigned int slot_counter(unsigned int slot) {
+	const unsigned int offset = slot * sizeof(audit_slot_t);
+	const unsigned int counter = ring_counter(offset);
+	if (counter != ring_counter(offset + sizeof(audit_record_t))) {
+		return 0;
+	}
+	return counter;
+}
+
+/** writes the first page_count pages in RAM to NVRAM, the last one may be partial, then drops the full ones from RAM. */
+static void write_pages(unsigned int page_count) {
+	for (unsigned int ix = 0; ix < page_count; ix++) {
+		const unsigned int page = (audit_log.buffer_page + ix) % AUDIT_LOG_RING_PAGES;
+		const unsigned int len = audit_log.buffer_len - (ix * AUDIT_LOG_NVRAM_PAGE);
+		// the rest of a partial page is left as it is, it is the start of the oldest record.
+		nvm_write(((unsigned char *) &N_audit_log) + (page * AUDIT_LOG_NVRAM_PAGE), audit_log.buffer + (ix * AUDIT_LOG_NVRAM_PAGE),
+				(len < AUDIT_LOG_NVRAM_PAGE) ? len : AUDIT_LOG_NVRAM_PAGE);
+	}
+	// a partial page stays in RAM, the next records go on filling it.
+	const unsigned int full_count = audit_log.buffer_len / AUDIT_LOG_NVRAM_PAGE;
+	const unsigned int drop_count = (page_count < full_count) ? page_count : full_count;
+	audit_log.buffer_page = (audit_log.buffer_page + drop_count) % AUDIT_LOG_RING_PAGES;
+	audit_log.buffer_len -= drop_count * AUDIT_LOG_NVRAM_PAGE;
+	os_memmove(audit_log.buffer, audit_log.buffer + (drop_count * AUDIT_LOG_NVRAM_PAGE), audit_log.buffer_len);
+}
+
+void audit_log_init(void) {
+	os_memset(&audit_log, 0x00, sizeof(audit_log));
+	// the newest record has the highest counter, the log continues after it, over a record written only in part.
+	unsigned int newest = 0;
+	for (unsigned int ix = 0; ix < AUDIT_LOG_SIZE; ix++) {
+		const unsigned int counter = slot_counter(ix);
+		if (counter > newest) {
+			newest = counter;
+			audit_log.head = (ix + 1) % AUDIT_LOG_SIZE;
+		}
+	}
+	audit_log.next_counter = newest + 1;
+
+	// the page the next record starts on goes on in RAM, with the slots already on it.
+	const unsigned int offset = audit_log.head * sizeof(audit_slot_t);
+	const unsigned int page_offset = offset - (offset % AUDIT_LOG_NVRAM_PAGE);
+	for (unsigned int ix = 0; ix < (offset - page_offset); ix++) {
+		audit_log.buffer[ix] = ring_byte(page_offset + ix);
+	}
+	audit_log.buffer_page = page_offset / AUDIT_LOG_NVRAM_PAGE;
+	audit_log.buffer_len = offset - page_offset;
+}
+
+void audit_log_add(const unsigned char * tx_hash, const tx_summary_t * summary) {
+	// only when signatures came faster than the ticker, the full pages are written now.
+	if ((audit_log.buffer_len + sizeof(audit_slot_t)) > sizeof(audit_log.buffer)) {
+		write_pages(audit_log.buffer_len / AUDIT_LOG_NVRAM_PAGE);
+	}
+	audit_slot_t * slot = (audit_slot_t *) (audit_log.buffer + audit_log.buffer_len);
+	os_memset(slot, 0x00, sizeof(audit_slot_t));
+	write_u32_be(slot->record.counter, audit_log.next_counter);
+	os_memmove(slot->record.tx_hash, tx_hash, SHA256_HASH_LEN);
+	if (summary != NULL) {
+		os_memmove(slot->record.to, summary->to, SCRIPT_HASH_LEN);
+		write_u64_be(slot->record.value, UPPER(UPPER(summary->value)));
+		write_u64_be(slot->record.value + 8, LOWER(UPPER(summary->value)));
+		write_u64_be(slot->record.value + 16, UPPER(LOWER(summary->value)));
+		write_u64_be(slot->record.value + 24, LOWER(LOWER(summary->value)));
+	}
+	write_u32_be(slot->end_counter, audit_log.next_counter);
+	audit_log.buffer_len += sizeof(audit_slot_t);
+	audit_log.head = (audit_log.head + 1) % AUDIT_LOG_SIZE;
+	audit_log.next_counter++;
+}
+
+void audit_log_tick(void) {
+	if (audit_log.buffer_len >= AUDIT_LOG_NVRAM_PAGE) {
+		write_pages(audit_log.buffer_len / AUDIT_LOG_NVRAM_PAGE);
+	}
+}
+
+void audit_log_flush(void) {
+	write_pages((audit_log.buffer_len + AUDIT_LOG_NVRAM_PAGE - 1) / AUDIT_LOG_NVRAM_PAGE);
+}
+
+unsigned int audit_log_read_page(unsigned int page_ix, unsigned char * out) {
+	unsigned int tx = 1;
+	unsigned char count = 0;
+	for (unsigned int ix = 0; ix < AUDIT_LOG_PAGE_RECORDS; ix++) {
+		const unsigned int age = (page_ix * AUDIT_LOG_PAGE_RECORDS) + ix;
+		if (age >= AUDIT_LOG_SIZE) {
+			break;
+		}
+		const unsigned int slot = (audit_log.head + AUDIT_LOG_SIZE - 1 - age) % AUDIT_LOG_SIZE;
+		// the ring is not full yet, there are no older records, or the oldest was being replaced on a power off.
+		if (slot_counter(slot) == 0) {
+			break;
+		}
+		for (unsigned int byte_ix = 0; byte_ix < sizeof(audit_record_t); byte_ix++) {
+			out[tx + byte_ix] = ring_byte((slot * sizeof(audit_slot_t)) + byte_ix);
+		}
+		tx += sizeof(audit_record_t);
+		count++;
+	}
+	out[0] = count;
+	return tx;
+}
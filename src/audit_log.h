@@ -0,0 +1,47 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef AUDIT_LOG_H
+#define AUDIT_LOG_H
+
+#include "os.h"
+#include "cx.h"
+#include <stdbool.h>
+#include "ui.h"
+#include "cpx.h"
+#include "sha256_hash_len.h"
+
+/** number of signed transactions kept in NVRAM, the oldest one is replaced first. */
+#define AUDIT_LOG_SIZE 64
+
+/** size of an NVRAM page, the log is written one whole page at a time. */
+#define AUDIT_LOG_NVRAM_PAGE 64
+
+/** number of records in the response to a read request, the count and the records must fit in the response. */
+#define AUDIT_LOG_PAGE_RECORDS 2
+
+/** finds where the log continues, from the records in NVRAM, called once at startup. */
+void audit_log_init(void);
+
+/**
+ * records the signature of the transaction hash, with the recipient and value of the summary, or zeros if it is not a transfer.
+ * the record is copied to the pages kept in RAM, signing doesn't wait for the flash. the pages are written by
+ * audit_log_tick once full, and the last one by audit_log_flush on exit, records in RAM are lost on a power off.
+ * only if the RAM pages can't hold the record, because signatures came faster than the ticker, the full pages
+ * are written first, before the record is copied.
+ */
+void audit_log_add(const unsigned char * tx_hash, const tx_summary_t * summary);
+
+/** writes the full pages kept in RAM to NVRAM, one page per write, called on each ticker event, outside of any request. */
+void audit_log_tick(void);
+
+/** writes all the pages kept in RAM, the last one even if it is not full, before exiting. */
+void audit_log_flush(void);
+
+/**
+ * writes the count, then up to AUDIT_LOG_PAGE_RECORDS records of the page at page_ix into out, newest first, and returns the length.
+ * each record is the counter (4 bytes), the transaction hash, the recipient script hash and the value (32 bytes), big endian.
+ */
+unsigned int audit_log_read_page(unsigned int page_ix, unsigned char * out);
+
+#endif // AUDIT_LOG_H
@@ -0,0 +1,128 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "batch.h"
+#include "keys.h"
+#include "audit_log.h"
+#include "call_counts.h"
+#include "trace.h"
+
+/** the transactions queued for signing after a single review. */
+static struct {
+	unsigned char tx_count;
+	bool approved;
+	/** bit ix is set once the transaction at ix was signed and recorded in the audit log, it can be signed again if the host lost it. */
+	unsigned char logged;
+	uint256_t total_value;
+	uint256_t total_fee;
+	batch_tx_t tx[MAX_BATCH_TX_COUNT];
+} batch;
+
+void batch_reset(void) {
+	os_memset(&batch, 0x00, sizeof(batch));
+}
+
+/** adds number to total, throws an error if the total would overflow. */
+static void add_to_total(uint256_t * total, uint256_t * number) {
+	uint256_t sum;
+	add256(total, number, &sum);
+	if (gt256(number, &sum)) {
+		hashTainted = 1;
+		THROW(0x6D1F);
+	}
+	copy256(total, &sum);
+}
+
+unsigned char batch_add_tx(void) {
+	// the signatures of an approved batch were handed out, the next transaction starts a new batch.
+	if (batch.approved) {
+		batch_reset();
+	}
+	if (batch.tx_count >= MAX_BATCH_TX_COUNT) {
+		hashTainted = 1;
+		THROW(0x6D1B);
+	}
+	if (raw_tx_len < BIP44_BYTE_LENGTH) {
+		hashTainted = 1;
+		THROW(0x6D18);
+	}
+	raw_tx_body_len = raw_tx_len - BIP44_BYTE_LENGTH;
+
+	batch_tx_t * tx = &batch.tx[batch.tx_count];
+	cx_hash(&hash.header, CX_LAST, raw_tx, raw_tx_body_len, tx->tx_hash, sizeof(tx->tx_hash));
+	read_bip44_path(raw_tx + raw_tx_body_len, tx->bip44_path);
+
+	// only the path must not be parsed as part of the transaction.
+	raw_tx_len = raw_tx_body_len;
+	raw_tx_ix = 0;
+	// a batch is reviewed by its totals, so only plain transfers can be in it.
+	if (!parse_tx_summary(&tx->summary)) {
+		hashTainted = 1;
+		THROW(0x6D1C);
+	}
+
+	add_to_total(&batch.total_value, &tx->summary.value);
+	add_to_total(&batch.total_fee, &tx->summary.fee);
+
+	// the raw transaction is not needed anymore, the next one can be uploaded.
+	hashTainted = 1;
+	raw_tx_ix = 0;
+	raw_tx_len = 0;
+
+	return batch.tx_count++;
+}
+
+unsigned char batch_tx_count(void) {
+	return batch.tx_count;
+}
+
+const batch_tx_t * batch_get_tx(unsigned int ix) {
+	return &batch.tx[ix];
+}
+
+const uint256_t * batch_total_value(void) {
+	return &batch.total_value;
+}
+
+const uint256_t * batch_total_fee(void) {
+	return &batch.total_fee;
+}
+
+unsigned char batch_distinct_recipients(void) {
+	unsigned char count = 0;
+	for (unsigned int ix = 0; ix < batch.tx_count; ix++) {
+		bool seen = false;
+		for (unsigned int prev_ix = 0; (prev_ix < ix) && !seen; prev_ix++) {
+			seen = (os_memcmp(batch.tx[prev_ix].summary.to, batch.tx[ix].summary.to, SCRIPT_HASH_LEN) == 0);
+		}
+		if (!seen) {
+			count++;
+		}
+	}
+	return count;
+}
+
+void batch_approve(void) {
+	batch.approved = true;
+}
+
+unsigned int batch_sign(unsigned int ix, unsigned char * signature, unsigned int signature_len) {
+	if (!batch.approved || (ix >= batch.tx_count)) {
+		THROW(0x6D1E);
+	}
+	const batch_tx_t * tx = &batch.tx[ix];
+
+	cx_ecfp_private_key_t privateKey;
+	derive_private_key(tx->bip44_path, &privateKey);
+	COUNT_CALL(CALL_COUNT_ECDSA_SIGN);
+	unsigned int len = cx_ecdsa_sign(&privateKey, CX_RND_RFC6979 | CX_LAST, CX_SHA256, tx->tx_hash, sizeof(tx->tx_hash), signature, signature_len,
+			NULL);
+	TRACE(TRACE_SIGN, len);
+	release_private_key(&privateKey);
+
+	if (!(batch.logged & (1 << ix))) {
+		batch.logged |= (1 << ix);
+		audit_log_add(tx->tx_hash, &tx->summary);
+	}
+	return len;
+}
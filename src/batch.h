@@ -0,0 +1,65 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "os.h"
+#include "cx.h"
+#include <stdbool.h>
+#include "ui.h"
+#include "cpx.h"
+#include "uint256.h"
+#include "sha256_hash_len.h"
+
+/**
+ * max number of transactions in a batch, each one keeps its hash, BIP44 path and summary in RAM until the batch is done.
+ * that is 136 bytes per transaction, from the 4 KB of RAM of the Nano S, which raw_tx (800 bytes), the io buffers and
+ * the stack already share, so 4 transactions take about 600 bytes with the totals. a payout run of hundreds of transfers
+ * is sent as consecutive batches, one review each.
+ * keeping only a running hash of the batch instead would need the host to prove, for each signature, that its
+ * transaction was in the reviewed batch, which the protocol doesn't do.
+ */
+#define MAX_BATCH_TX_COUNT 4
+
+/** a transaction queued in the batch. */
+typedef struct {
+	/** hash of the transaction, which is what gets signed. */
+	unsigned char tx_hash[SHA256_HASH_LEN];
+	/** BIP44 path to sign with. */
+	unsigned int bip44_path[BIP44_PATH_LEN];
+	/** what the transaction does, for the review. */
+	tx_summary_t summary;
+} batch_tx_t;
+
+/** forgets all the transactions of the batch, and the approval. */
+void batch_reset(void);
+
+/**
+ * parses and hashes the transaction in raw_tx, followed by its BIP44 path, and queues it in the batch.
+ * starts a new batch if the previous one was approved. returns the index of the transaction in the batch.
+ */
+unsigned char batch_add_tx(void);
+
+/** returns the number of transactions in the batch. */
+unsigned char batch_tx_count(void);
+
+/** returns the transaction at ix. */
+const batch_tx_t * batch_get_tx(unsigned int ix);
+
+/** returns the total value of the batch. */
+const uint256_t * batch_total_value(void);
+
+/** returns the total fee of the batch. */
+const uint256_t * batch_total_fee(void);
+
+/** returns the number of distinct recipients of the batch. */
+unsigned char batch_distinct_recipients(void);
+
+/** marks the batch as approved by the user, so its transactions can be signed. */
+void batch_approve(void);
+
+/** signs the transaction at ix of the approved batch into signature, and returns the length of the signature. */
+unsigned int batch_sign(unsigned int ix, unsigned char * signature, unsigned int signature_len);
+
+#endif // BATCH_H
@@ -0,0 +1,31 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "call_counts.h"
+
+#ifdef HAVE_CALL_COUNTS
+
+/** number of calls of each function since startup or the last reset, in RAM. */
+static unsigned int call_counts[CALL_COUNT_ID_COUNT];
+
+void call_count_add(enum CALL_COUNT_ID id) {
+	call_counts[id]++;
+}
+
+unsigned int call_counts_read(unsigned char * out) {
+	unsigned int len = 0;
+	out[len++] = CALL_COUNT_ID_COUNT;
+	for (unsigned int id = 0; id < CALL_COUNT_ID_COUNT; id++) {
+		out[len++] = (call_counts[id] >> 24) & 0xFF;
+		out[len++] = (call_counts[id] >> 16) & 0xFF;
+		out[len++] = (call_counts[id] >> 8) & 0xFF;
+		out[len++] = call_counts[id] & 0xFF;
+	}
+	return len;
+}
+
+void call_counts_reset(void) {
+	os_memset(call_counts, 0x00, sizeof(call_counts));
+}
+
+#endif // HAVE_CALL_COUNTS
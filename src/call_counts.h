@@ -0,0 +1,43 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef CALL_COUNTS_H
+#define CALL_COUNTS_H
+
+#include "os.h"
+
+/** the functions on the hot paths whose calls are counted, in the order of the counts in the response. */
+enum CALL_COUNT_ID {
+	CALL_COUNT_DISPLAY_TX_DESC,
+	CALL_COUNT_TO_ADDRESS,
+	CALL_COUNT_ENCODE_BASE_X,
+	CALL_COUNT_TOSTRING256,
+	CALL_COUNT_DIVMOD256,
+	CALL_COUNT_DIVMOD256_SMALL,
+	CALL_COUNT_DERIVE_NODE,
+	CALL_COUNT_ECDSA_SIGN,
+	CALL_COUNT_ID_COUNT
+};
+
+#ifdef HAVE_CALL_COUNTS
+
+/** counts a call of the function. */
+#define COUNT_CALL(id) call_count_add(id)
+
+/** counts a call of the function. */
+void call_count_add(enum CALL_COUNT_ID id);
+
+/** writes the number of counts followed by each count, 4 bytes big endian, to out, and returns the length written. */
+unsigned int call_counts_read(unsigned char * out);
+
+/** sets all counts back to zero. */
+void call_counts_reset(void);
+
+#else // HAVE_CALL_COUNTS
+
+/** counts a call of the function, only with HAVE_CALL_COUNTS. */
+#define COUNT_CALL(id)
+
+#endif // HAVE_CALL_COUNTS
+
+#endif // CALL_COUNTS_H
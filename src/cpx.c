@@ -2,6 +2,16 @@
  * MIT License, see root folder for full license.
  */
 #include "cpx.h"
+#include "keys.h"
+#include "batch.h"
+#include "policy.h"
+#include "message.h"
+#include "allow_list.h"
+#include "settings.h"
+#include "paginator.h"
+#include "scratch.h"
+#include "call_counts.h"
+#include "trace.h"
 #include "uint256.h"
 
 #include <string.h>
@@ -27,9 +37,6 @@
 /** length of tx.output.nonce */
 #define NONCE_LEN 8
 
-/** length of tx.output.script_hash */
-#define SCRIPT_HASH_LEN 20
-
 /** length of the checksum used to convert a tx.output.script_hash into an Address. */
 #define SCRIPT_HASH_CHECKSUM_LEN 4
 
@@ -39,6 +46,9 @@
 /** length of a tx.output Address before encoding, which is the length of <address_prefix>+<script_hash>+<checksum> */
 #define ADDRESS_LEN (2 + SCRIPT_HASH_LEN + SCRIPT_HASH_CHECKSUM_LEN)
 
+/** max number of bytes encode_base_x converts, an address is the longest. */
+#define MAX_ENCODE_LEN ADDRESS_LEN
+
 /** Apex address prefix */
 #define APEX_ADDRESS_PREFIX_1	0x05	// bin for 'A'
 #define APEX_ADDRESS_PREFIX_2	0x48	// bin for 'P'
@@ -46,8 +56,41 @@
 /** number of digits for CPX */
 #define CPX_DIGITS 18
 
-/** max value char size */
-#define CPX_VALUE_BUFFER_SIZE 32
+/** max value char size, the 78 digits of the largest 32 byte amount and the terminating zero. */
+#define CPX_VALUE_BUFFER_SIZE 79
+
+/** max length of a tx.output value or fee, in bytes. */
+#define CPX_AMOUNT_MAX_LEN 32
+
+/** number of summary screens of a batch, before the screens of each transaction. */
+#define BATCH_SUMMARY_SCREENS 4
+
+/** number of screens of each transaction of a batch, its value and its recipient. */
+#define BATCH_TX_SCREENS 2
+
+/** number of screens of a spending policy, before the screens of each allowed recipient. */
+#define POLICY_SUMMARY_SCREENS 4
+
+/** number of screens of a message, the preview, the length and the hash over two screens. */
+#define MESSAGE_SCREENS 4
+
+/** number of screens of a recipient to add to the allow-list, its address and its label. */
+#define RECIPIENT_SCREENS 2
+
+/** number of screens of an exit timeout to set, the current one and the new one. */
+#define EXIT_TIMEOUT_SCREENS 2
+
+/** max number of fields of a transaction that are displayed, one per screen. */
+#define MAX_TX_FIELDS 7
+
+/** number of characters of an address on a line, base58 has many wide letters. */
+#define ADDRESS_LINE_WIDTH 12
+
+/** number of characters of an amount on a line. */
+#define AMOUNT_LINE_WIDTH 14
+
+/** number of characters of text or hex on a line. */
+#define TEXT_LINE_WIDTH 16
 
 /**
  * transaction types.
@@ -70,6 +113,71 @@ static const char TXT_ASSET_VALUE_NAME[] = "Value";
 /** CPX fee label. */
 static const char TXT_ASSET_FEE[] = "Fee";
 
+/** Signing keys label, when signing with several BIP44 paths */
+static const char TXT_SIGNING_KEYS[] = "Signing Keys";
+
+/** Batch transaction count label */
+static const char TXT_BATCH_TX_COUNT[] = "Transactions";
+
+/** Batch total value label */
+static const char TXT_BATCH_TOTAL_VALUE[] = "Total Value";
+
+/** Batch total fee label */
+static const char TXT_BATCH_TOTAL_FEE[] = "Total Fee";
+
+/** Batch distinct recipients label */
+static const char TXT_BATCH_RECIPIENTS[] = "Recipients";
+
+/** Spending policy account label */
+static const char TXT_POLICY_ACCOUNT[] = "Auto Sign";
+
+/** Spending policy max value label */
+static const char TXT_POLICY_MAX_VALUE[] = "Max Per Tx";
+
+/** Spending policy budget label */
+static const char TXT_POLICY_BUDGET[] = "Budget";
+
+/** Spending policy duration label */
+static const char TXT_POLICY_VALID_FOR[] = "Valid For";
+
+/** Spending policy duration, when valid until the app exits */
+static const char TXT_POLICY_SESSION[] = "Session";
+
+/** Spending policy recipient label, followed by its number */
+static const char TXT_POLICY_RECIPIENT[] = "Recipient";
+
+/** Message preview label */
+static const char TXT_MESSAGE[] = "Message";
+
+/** Message length label */
+static const char TXT_MESSAGE_LENGTH[] = "Length";
+
+/** Message hash labels, the hash takes two screens */
+static const char TXT_MESSAGE_HASH_1[] = "SHA-256 1/2";
+static const char TXT_MESSAGE_HASH_2[] = "SHA-256 2/2";
+
+/** added to the label of a field whose recipient is on the allow-list */
+static const char TXT_KNOWN_SUFFIX[] = " (known)";
+
+/** label of a field whose recipient is on the allow-list, when the label and TXT_KNOWN_SUFFIX don't fit */
+static const char TXT_KNOWN_RECIPIENT[] = "Known Recipient";
+
+/** label of the label of a recipient to add to the allow-list */
+static const char TXT_RECIPIENT_LABEL[] = "Label";
+
+/** exit timeout labels, the current one and the one to set */
+static const char TXT_EXIT_TIMEOUT_CURRENT[] = "Current Timeout";
+static const char TXT_EXIT_TIMEOUT_NEW[] = "New Timeout";
+
+/** Address label */
+static const char TXT_ADDRESS[] = "Address";
+
+/** From address label */
+static const char TXT_FROM[] = "From";
+
+/** To address label */
+static const char TXT_TO[] = "To";
+
 /** Version label */
 static const char TXT_VERSION[] = "Version";
 
@@ -98,7 +206,22 @@ static const char TX_SCHEDULE_NM[] = "Schedule";
 static const char NO_PUBLIC_KEY_0[] = "No Public Key";
 static const char NO_PUBLIC_KEY_1[] = "Requested Yet";
 
-int screen_index_page_type[MAX_TX_TEXT_SCREENS];
+/** fields of the transaction that are displayed. */
+enum TX_FIELD {
+	FIELD_VERSION, FIELD_TX_TYPE, FIELD_FROM_ADDRESS, FIELD_TO_ADDRESS, FIELD_VALUE, FIELD_FEE, FIELD_SIGNING_KEYS
+};
+
+/**
+ * type and offset in raw_tx of each field of the transaction being reviewed, one per screen.
+ * display_tx_desc only finds the fields, each one is formatted when its screen is displayed.
+ */
+static struct {
+	unsigned char type;
+	unsigned short offset;
+} tx_fields[MAX_TX_FIELDS];
+
+/** the field of the screen being displayed, rendered when its screen is loaded. */
+static field_text_t curr_field;
 
 /** array of capital letter hex values */
 static const char HEX_CAP[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F', };
@@ -123,6 +246,12 @@ static void next_raw_tx_arr(unsigned char * arr, const unsigned int length);
 /** reads the next byte out of the transaction, or throws an error if there are no more bytes left. */
 static unsigned char next_raw_tx();
 
+/** reads a variable length value or fee into amount, throws an error if it is longer than 32 bytes. */
+static void next_raw_tx_amount(uint256_t * amount);
+
+/** renders the screen at scr_ix of what is being reviewed into field. */
+static void render_screen(field_text_t * field, unsigned int scr_ix);
+
 /** returns the minimum of i0 and i1 */
 static unsigned int min(const unsigned int i0, const unsigned int i1);
 
@@ -146,24 +275,23 @@ static unsigned int encode_base_58(const void *in, const unsigned int in_len, ch
 /** encodes in_length bytes from in into the given base, using the given alphabet. writes the converted bytes to out, stopping when it converts out_length bytes. */
 static unsigned int encode_base_x(const char * alphabet, const unsigned int alphabet_len, const void * in, const unsigned int in_length, char * out,
 		const unsigned int out_length) {
-	char tmp[164];
-	char buffer[164];
+	COUNT_CALL(CALL_COUNT_ENCODE_BASE_X);
 	unsigned char buffer_ix;
 	unsigned char startAt;
 	unsigned char zeroCount = 0;
-	if (in_length > sizeof(tmp)) {
+	if (in_length > MAX_ENCODE_LEN) {
 		hashTainted = 1;
 		THROW(0x6D11);
 	}
+	// the digits are written from the end of buffer, 2 characters per byte are enough for base 16 and up.
+	const unsigned int mark = scratch_mark();
+	unsigned char * tmp = scratch_alloc(in_length);
+	char * buffer = scratch_alloc(2 * in_length);
 	os_memmove(tmp, in, in_length);
 	while ((zeroCount < in_length) && (tmp[zeroCount] == 0)) {
 		++zeroCount;
 	}
 	buffer_ix = 2 * in_length;
-	if (buffer_ix > sizeof(buffer)) {
-		hashTainted = 1;
-		THROW(0x6D12);
-	}
 
 	startAt = zeroCount;
 	while (startAt < in_length) {
@@ -193,6 +321,7 @@ static unsigned int encode_base_x(const char * alphabet, const unsigned int alph
 		THROW(0x6D14);
 	}
 	os_memmove(out, (buffer + buffer_ix), total_length);
+	scratch_release(mark);
 	return total_length;
 }
 
@@ -261,11 +390,13 @@ bool adjustDecimals(char *src, uint32_t srcLength, char *target,
     return true;
 }
 
-/** converts a CPX scripthash to a CPX address by adding a checksum and encoding in base58 */
-static void to_address(char * dest, unsigned int dest_len, const unsigned char * script_hash) {
-	static cx_sha256_t address_hash;
-	unsigned char address_hash_result_0[SHA256_HASH_LEN];
-	unsigned char address_hash_result_1[SHA256_HASH_LEN];
+/** converts a CPX scripthash to a CPX address by adding a checksum and encoding in base58, returns the length of the address. */
+static unsigned int to_address(char * dest, unsigned int dest_len, const unsigned char * script_hash) {
+	COUNT_CALL(CALL_COUNT_TO_ADDRESS);
+	const unsigned int mark = scratch_mark();
+	cx_sha256_t * address_hash = scratch_alloc(sizeof(cx_sha256_t));
+	unsigned char * address_hash_result_0 = scratch_alloc(SHA256_HASH_LEN);
+	unsigned char * address_hash_result_1 = scratch_alloc(SHA256_HASH_LEN);
 
 	// concatenate the address prefix ("AP")and the address.
 	unsigned char address[ADDRESS_LEN];
@@ -274,16 +405,17 @@ static void to_address(char * dest, unsigned int dest_len, const unsigned char *
 	os_memmove(address + 2, script_hash, SCRIPT_HASH_LEN);
 
 	// do a sha256 hash of the address twice.
-	cx_sha256_init(&address_hash);
-	cx_hash(&address_hash.header, CX_LAST, address, SCRIPT_HASH_LEN + 2, address_hash_result_0, SHA256_HASH_LEN);
-	cx_sha256_init(&address_hash);
-	cx_hash(&address_hash.header, CX_LAST, address_hash_result_0, SHA256_HASH_LEN, address_hash_result_1, SHA256_HASH_LEN);
+	cx_sha256_init(address_hash);
+	cx_hash(&address_hash->header, CX_LAST, address, SCRIPT_HASH_LEN + 2, address_hash_result_0, SHA256_HASH_LEN);
+	cx_sha256_init(address_hash);
+	cx_hash(&address_hash->header, CX_LAST, address_hash_result_0, SHA256_HASH_LEN, address_hash_result_1, SHA256_HASH_LEN);
 
 	// add the first bytes of the hash as a checksum at the end of the address.
 	os_memmove(address + 2 + SCRIPT_HASH_LEN, address_hash_result_1, SCRIPT_HASH_CHECKSUM_LEN);
+	scratch_release(mark);
 
 	// encode the version + address + checksum in base58
-	encode_base_58(address, ADDRESS_LEN, dest, dest_len);
+	return encode_base_58(address, ADDRESS_LEN, dest, dest_len);
 }
 
 /** converts a byte array in src to a hex array in dest, using only dest_len bytes of dest before stopping. */
@@ -363,178 +495,463 @@ static unsigned char next_raw_tx() {
 	}
 }
 
-unsigned char display_tx_desc() {
-	unsigned int scr_ix = 0;
+/** reads the length of the amount, then the amount, which must fit in 32 bytes. */
+static void next_raw_tx_amount(uint256_t * amount) {
+	unsigned char amount_bytes[CPX_AMOUNT_MAX_LEN];
+	unsigned char amount_len = next_raw_tx();
+	if (amount_len > CPX_AMOUNT_MAX_LEN) {
+		hashTainted = 1;
+		THROW(0x6D1A);
+	}
+	next_raw_tx_arr(amount_bytes, amount_len);
+	convertUint256BE(amount_bytes, amount_len, amount);
+}
 
-	// tx version
-	unsigned char tx_version[CPX_TX_VERSION_LEN];
-	next_raw_tx_arr(tx_version, CPX_TX_VERSION_LEN);
-	if (SHOW_TX_VERSION) {
-		char hex_buffer[MAX_TX_TEXT_WIDTH];
-		unsigned int hex_buffer_len = 0;
+/** sets the value of the field to the CPX address of the script hash. */
+static void address_value(field_text_t * field, const unsigned char * script_hash) {
+	field->line_width = ADDRESS_LINE_WIDTH;
+	field->value_len = to_address(field->value, sizeof(field->value), script_hash);
+}
+
+/** sets the value of the field to the amount in CPX. */
+static void amount_value(field_text_t * field, const uint256_t * amount) {
+	char srcBuffer[CPX_VALUE_BUFFER_SIZE];
 
-		if (scr_ix < MAX_TX_TEXT_SCREENS) {
-			os_memmove(tx_desc[scr_ix][0], TXT_VERSION, sizeof(TXT_VERSION));
+	if (!tostring256((uint256_t *) amount, 10, srcBuffer, sizeof(srcBuffer))
+			|| !adjustDecimals(srcBuffer, strlen(srcBuffer), field->value, sizeof(field->value), CPX_DIGITS)) {
+		hashTainted = 1;
+		THROW(0x6D1A);
+	}
+	field->line_width = AMOUNT_LINE_WIDTH;
+	field->value_len = strlen(field->value);
+}
 
-			hex_buffer_len = min(MAX_HEX_BUFFER_LEN, CPX_TX_VERSION_LEN) * 2;
-			to_hex(hex_buffer, tx_version, hex_buffer_len);
-			os_memmove(tx_desc[scr_ix][1], hex_buffer, hex_buffer_len);
+/** sets the value of the field to the hex of src_len bytes of src. */
+static void hex_value(field_text_t * field, const unsigned char * src, unsigned int src_len) {
+	src_len = min(src_len, sizeof(field->value) / 2);
+	to_hex(field->value, src, src_len * 2);
+	field->line_width = TEXT_LINE_WIDTH;
+	field->value_len = src_len * 2;
+}
 
-			screen_index_page_type[scr_ix] = SINGLE_PAGE;
-			scr_ix++;
-		}
+/** sets the value of the field to text_len characters of text. */
+static void text_value(field_text_t * field, const char * text, unsigned int text_len) {
+	text_len = min(text_len, sizeof(field->value));
+	os_memmove(field->value, text, text_len);
+	field->line_width = TEXT_LINE_WIDTH;
+	field->value_len = text_len;
+}
+
+/** sets the value of the field to the label of the recipient if it is on the allow-list, and marks the field as known, otherwise to its address. */
+static void recipient_value(field_text_t * field, const unsigned char * script_hash) {
+	const char * label = allow_list_lookup(script_hash);
+	if (label == NULL) {
+		address_value(field, script_hash);
+		return;
+	}
+	const unsigned int label_len = strlen(field->label);
+	if (label_len + sizeof(TXT_KNOWN_SUFFIX) <= sizeof(field->label)) {
+		os_memmove(field->label + label_len, TXT_KNOWN_SUFFIX, sizeof(TXT_KNOWN_SUFFIX));
+	} else {
+		snprintf(field->label, sizeof(field->label), "%s", TXT_KNOWN_RECIPIENT);
 	}
+	text_value(field, label, strlen(label));
+}
 
-	// tx type
+/** sets the value of the field to the number, formatted with format. */
+static void number_value(field_text_t * field, const char * format, unsigned int number) {
+	snprintf(field->value, sizeof(field->value), format, number);
+	field->line_width = TEXT_LINE_WIDTH;
+	field->value_len = strlen(field->value);
+}
+
+bool parse_tx_summary(tx_summary_t * summary) {
+	skip_raw_tx(CPX_TX_VERSION_LEN);
+
+	// the summary says all a transfer does, but not what other transaction types do.
 	enum TX_TYPE trans_type = next_raw_tx();
-	if (SHOW_TX_TYPE) {
-		if (scr_ix < MAX_TX_TEXT_SCREENS) {
-			// add transaction type screen.
-			os_memmove(tx_desc[scr_ix][0], TXT_TX_TYPE, sizeof(TXT_TX_TYPE));
-			switch (trans_type) {
-			case TX_MINER:
-				os_memmove(tx_desc[scr_ix][1], TX_MINER_NM, sizeof(TX_MINER_NM));
-				break;
-
-			case TX_TRANSFER:
-				os_memmove(tx_desc[scr_ix][1], TX_TRANSFER_NM, sizeof(TX_TRANSFER_NM));
-				break;
-
-			case TX_DEPLOY:
-				os_memmove(tx_desc[scr_ix][1], TX_DEPLOY_NM, sizeof(TX_DEPLOY_NM));
-				break;
-
-			case TX_CALL:
-				os_memmove(tx_desc[scr_ix][1], TX_CALL_NM, sizeof(TX_CALL_NM));
-				break;
-
-			case TX_REFUND:
-				os_memmove(tx_desc[scr_ix][1], TX_REFUND_NM, sizeof(TX_REFUND_NM));
-				break;
-
-			case TX_SCHEDULE:
-				os_memmove(tx_desc[scr_ix][1], TX_SCHEDULE_NM, sizeof(TX_SCHEDULE_NM));
-				break;
-
-			default:
-				hashTainted = 1;
-				THROW(0x6D06);
-			}
-
-			screen_index_page_type[scr_ix] = SINGLE_PAGE;
-			scr_ix++;
-		}
+	if (trans_type != TX_TRANSFER) {
+		return false;
 	}
 
-	// addresses
-	unsigned char addressHash[SCRIPT_HASH_LEN];
-	next_raw_tx_arr(addressHash, SCRIPT_HASH_LEN);
+	skip_raw_tx(SCRIPT_HASH_LEN);
+	next_raw_tx_arr(summary->to, SCRIPT_HASH_LEN);
+	next_raw_tx_amount(&summary->value);
+	skip_raw_tx(NONCE_LEN);
+	unsigned char data_len = next_raw_tx();
+	skip_raw_tx(data_len);
+	next_raw_tx_amount(&summary->fee);
+	return true;
+}
 
-	char address_base58[ADDRESS_BASE58_LEN];
-	unsigned int address_base58_len_0 = 12;
-	unsigned int address_base58_len_1 = 11;
-	unsigned int address_base58_len_2 = 12;
+/** adds a field of the transaction, starting at the current position in raw_tx, to the list of screens. */
+static void add_tx_field(unsigned int * field_count, enum TX_FIELD type) {
+	tx_fields[*field_count].type = type;
+	tx_fields[*field_count].offset = raw_tx_ix;
+	(*field_count)++;
+}
 
-	char * address_base58_0 = address_base58;
-	char * address_base58_1 = address_base58 + address_base58_len_0;
-	char * address_base58_2 = address_base58 + address_base58_len_0 + address_base58_len_1;
+/**
+ * renders the amount once, as the fields are collected, so an amount that can't be displayed is rejected before the
+ * review starts, and rendering the screens later doesn't throw.
+ */
+static void check_amount(const uint256_t * amount) {
+	amount_value(&curr_field, amount);
+}
+
+/** sets the number of screens, and renders the first one. */
+static void display_desc(unsigned int scr_count) {
+	TRACE(TRACE_PARSE, (review_type << 16) | scr_count);
+	max_scr_ix = scr_count;
+	curr_scr_ix = 0;
+	load_tx_desc_screen(curr_scr_ix);
+}
+
+unsigned char display_tx_desc() {
+	COUNT_CALL(CALL_COUNT_DISPLAY_TX_DESC);
+	unsigned int field_count = 0;
+	uint256_t uint256;
+
+	// tx version
+	if (SHOW_TX_VERSION) {
+		add_tx_field(&field_count, FIELD_VERSION);
+	}
+	skip_raw_tx(CPX_TX_VERSION_LEN);
+
+	// tx type
+	if (SHOW_TX_TYPE) {
+		add_tx_field(&field_count, FIELD_TX_TYPE);
+	}
+	enum TX_TYPE trans_type = next_raw_tx();
+	if (SHOW_TX_TYPE && (trans_type > TX_SCHEDULE)) {
+		hashTainted = 1;
+		THROW(0x6D06);
+	}
 
 	// from address
 	if (SHOW_FROM_ADDRESS) {
-		to_address(address_base58, ADDRESS_BASE58_LEN, addressHash);
-		// address screen
-		if (scr_ix < MAX_TX_TEXT_SCREENS) {
-			os_memset(tx_desc[scr_ix], '\0', CURR_TX_DESC_LEN);
-			os_memmove(tx_desc[scr_ix][0], address_base58_0, address_base58_len_0);
-			os_memmove(tx_desc[scr_ix][1], address_base58_1, address_base58_len_1);
-			os_memmove(tx_desc[scr_ix][2], address_base58_2, address_base58_len_2);
-
-			screen_index_page_type[scr_ix] = TWO_PAGE;
-			scr_ix++;
-		}
+		add_tx_field(&field_count, FIELD_FROM_ADDRESS);
 	}
+	skip_raw_tx(SCRIPT_HASH_LEN);
+
 	// to address
-	next_raw_tx_arr(addressHash, SCRIPT_HASH_LEN);
-	to_address(address_base58, ADDRESS_BASE58_LEN, addressHash);
+	add_tx_field(&field_count, FIELD_TO_ADDRESS);
+	skip_raw_tx(SCRIPT_HASH_LEN);
+
+	// value (variable length), read to check it can be displayed.
+	add_tx_field(&field_count, FIELD_VALUE);
+	next_raw_tx_amount(&uint256);
+	check_amount(&uint256);
+
+	// nonce
+	skip_raw_tx(NONCE_LEN);
+
+	// data (variable length)
+	unsigned char data_len = next_raw_tx();
+	skip_raw_tx(data_len);
 
-	// address screen
-	if (scr_ix < MAX_TX_TEXT_SCREENS) {
-		os_memset(tx_desc[scr_ix], '\0', CURR_TX_DESC_LEN);
-		os_memmove(tx_desc[scr_ix][0], address_base58_0, address_base58_len_0);
-		os_memmove(tx_desc[scr_ix][1], address_base58_1, address_base58_len_1);
-		os_memmove(tx_desc[scr_ix][2], address_base58_2, address_base58_len_2);
+	// fee (variable length), read to check it can be displayed.
+	add_tx_field(&field_count, FIELD_FEE);
+	next_raw_tx_amount(&uint256);
+	check_amount(&uint256);
 
-		screen_index_page_type[scr_ix] = TWO_PAGE;
-		scr_ix++;
+	// number of keys signing, if there are several.
+	if (sign_path_count > 1) {
+		add_tx_field(&field_count, FIELD_SIGNING_KEYS);
 	}
 
-	// value (variable length)
-	char srcBuffer[CPX_VALUE_BUFFER_SIZE];
-	char dstBuffer[CPX_VALUE_BUFFER_SIZE];
+	display_desc(field_count);
+
+	return 1;
+}
+
+/** renders the field of the transaction at field_ix. */
+static void tx_field_screen(field_text_t * field, unsigned int field_ix) {
+	unsigned char addressHash[SCRIPT_HASH_LEN];
 	uint256_t uint256;
 
-	uint8_t value_len = next_raw_tx();
-	next_raw_tx_arr((unsigned char *) srcBuffer, value_len);
+	raw_tx_ix = tx_fields[field_ix].offset;
+	switch (tx_fields[field_ix].type) {
+	case FIELD_VERSION: {
+		unsigned char tx_version[CPX_TX_VERSION_LEN];
+		next_raw_tx_arr(tx_version, CPX_TX_VERSION_LEN);
+		paginator_init(field, TXT_VERSION, TEXT_LINE_WIDTH);
+		hex_value(field, tx_version, CPX_TX_VERSION_LEN);
+		break;
+	}
+
+	case FIELD_TX_TYPE:
+		paginator_init(field, TXT_TX_TYPE, TEXT_LINE_WIDTH);
+		switch (next_raw_tx()) {
+		case TX_MINER:
+			text_value(field, TX_MINER_NM, strlen(TX_MINER_NM));
+			break;
 
-	convertUint256BE((unsigned char *) srcBuffer, value_len, &uint256);
-	tostring256(&uint256, 10, srcBuffer, sizeof(srcBuffer));
-	adjustDecimals(srcBuffer, strlen(srcBuffer), dstBuffer, sizeof(dstBuffer), CPX_DIGITS);
+		case TX_TRANSFER:
+			text_value(field, TX_TRANSFER_NM, strlen(TX_TRANSFER_NM));
+			break;
 
-	unsigned int value_len_0 = 14;
-	unsigned int value_len_1 = 14;
-	char * value_0 = dstBuffer;
-	char * value_1 = dstBuffer + value_len_0;
+		case TX_DEPLOY:
+			text_value(field, TX_DEPLOY_NM, strlen(TX_DEPLOY_NM));
+			break;
 
-	if (scr_ix < MAX_TX_TEXT_SCREENS) {
-		os_memmove(tx_desc[scr_ix][0], TXT_ASSET_VALUE_NAME, sizeof(TXT_ASSET_VALUE_NAME));
-		os_memmove(tx_desc[scr_ix][1], value_0, value_len_0);
-		screen_index_page_type[scr_ix] = SINGLE_PAGE;
+		case TX_CALL:
+			text_value(field, TX_CALL_NM, strlen(TX_CALL_NM));
+			break;
 
-		if(strlen(dstBuffer) > value_len_0) {
-			os_memmove(tx_desc[scr_ix][2], value_1, value_len_1);
-			screen_index_page_type[scr_ix] = TWO_PAGE;
+		case TX_REFUND:
+			text_value(field, TX_REFUND_NM, strlen(TX_REFUND_NM));
+			break;
+
+		case TX_SCHEDULE:
+			text_value(field, TX_SCHEDULE_NM, strlen(TX_SCHEDULE_NM));
+			break;
+
+		default:
+			hashTainted = 1;
+			THROW(0x6D06);
 		}
-		scr_ix++;
+		break;
+
+	case FIELD_FROM_ADDRESS:
+		next_raw_tx_arr(addressHash, SCRIPT_HASH_LEN);
+		paginator_init(field, TXT_FROM, ADDRESS_LINE_WIDTH);
+		address_value(field, addressHash);
+		break;
+
+	case FIELD_TO_ADDRESS:
+		next_raw_tx_arr(addressHash, SCRIPT_HASH_LEN);
+		paginator_init(field, TXT_TO, ADDRESS_LINE_WIDTH);
+		recipient_value(field, addressHash);
+		break;
+
+	case FIELD_VALUE:
+		next_raw_tx_amount(&uint256);
+		paginator_init(field, TXT_ASSET_VALUE_NAME, AMOUNT_LINE_WIDTH);
+		amount_value(field, &uint256);
+		break;
+
+	case FIELD_FEE:
+		next_raw_tx_amount(&uint256);
+		paginator_init(field, TXT_ASSET_FEE, AMOUNT_LINE_WIDTH);
+		amount_value(field, &uint256);
+		break;
+
+	default:
+		paginator_init(field, TXT_SIGNING_KEYS, TEXT_LINE_WIDTH);
+		number_value(field, "%u", sign_path_count);
+		break;
 	}
+}
 
-	// nonce
-	unsigned char nonce[NONCE_LEN];
-	next_raw_tx_arr(nonce, NONCE_LEN);
+void display_batch_desc(void) {
+	// the value of each transaction was read like the one of a transaction to sign, only the totals are new amounts.
+	check_amount(batch_total_value());
+	check_amount(batch_total_fee());
 
-	// data (variable length)
-	unsigned char data_len = next_raw_tx();;
-	unsigned char data[data_len];
-	next_raw_tx_arr(data, data_len);
-
-	// fee (variable length)
-	uint8_t fee_len = next_raw_tx();;
-	next_raw_tx_arr((unsigned char *) srcBuffer, fee_len);
-
-	convertUint256BE((unsigned char *) srcBuffer, fee_len, &uint256);
-	tostring256(&uint256, 10, srcBuffer, sizeof(srcBuffer));
-	adjustDecimals(srcBuffer, strlen(srcBuffer), dstBuffer, sizeof(dstBuffer), CPX_DIGITS);
-
-	unsigned int fee_len_0 = 14;
-	unsigned int fee_len_1 = 14;
-	char * fee_0 = dstBuffer;
-	char * fee_1 = dstBuffer + value_len_0;
-
-	if (scr_ix < MAX_TX_TEXT_SCREENS) {
-		os_memmove(tx_desc[scr_ix][0], TXT_ASSET_FEE, sizeof(TXT_ASSET_FEE));
-		os_memmove(tx_desc[scr_ix][1], fee_0, fee_len_0);
-		screen_index_page_type[scr_ix] = SINGLE_PAGE;
-
-		if(strlen(dstBuffer) > fee_len_0) {
-			os_memmove(tx_desc[scr_ix][2], fee_1, fee_len_1);
-			screen_index_page_type[scr_ix] = TWO_PAGE;
+	// after the summary, the value and recipient of each transaction.
+	display_desc(BATCH_SUMMARY_SCREENS + (batch_tx_count() * BATCH_TX_SCREENS));
+}
+
+/** renders the screen of the batch at scr_ix, the summary then each transaction. */
+static void batch_screen(field_text_t * field, unsigned int scr_ix) {
+	switch (scr_ix) {
+	case 0:
+		paginator_init(field, TXT_BATCH_TX_COUNT, TEXT_LINE_WIDTH);
+		number_value(field, "%u", batch_tx_count());
+		return;
+
+	case 1:
+		paginator_init(field, TXT_BATCH_TOTAL_VALUE, AMOUNT_LINE_WIDTH);
+		amount_value(field, batch_total_value());
+		return;
+
+	case 2:
+		paginator_init(field, TXT_BATCH_TOTAL_FEE, AMOUNT_LINE_WIDTH);
+		amount_value(field, batch_total_fee());
+		return;
+
+	case 3:
+		paginator_init(field, TXT_BATCH_RECIPIENTS, TEXT_LINE_WIDTH);
+		number_value(field, "%u", batch_distinct_recipients());
+		return;
+
+	default:
+		break;
+	}
+
+	const unsigned int tx_ix = (scr_ix - BATCH_SUMMARY_SCREENS) / BATCH_TX_SCREENS;
+	const batch_tx_t * tx = batch_get_tx(tx_ix);
+	if ((scr_ix - BATCH_SUMMARY_SCREENS) % BATCH_TX_SCREENS == 0) {
+		paginator_init(field, TXT_ASSET_VALUE_NAME, AMOUNT_LINE_WIDTH);
+		snprintf(field->label, sizeof(field->label), "%s #%u", TXT_ASSET_VALUE_NAME, tx_ix + 1);
+		amount_value(field, &tx->summary.value);
+	} else {
+		paginator_init(field, TXT_TO, ADDRESS_LINE_WIDTH);
+		snprintf(field->label, sizeof(field->label), "%s #%u", TXT_TO, tx_ix + 1);
+		recipient_value(field, tx->summary.to);
+	}
+}
+
+void display_policy_desc(void) {
+	check_amount(policy_max_value());
+	check_amount(policy_budget());
+
+	// after the limits, the address of each allowed recipient.
+	display_desc(POLICY_SUMMARY_SCREENS + policy_recipient_count());
+}
+
+/** renders the screen of the spending policy at scr_ix. */
+static void policy_screen(field_text_t * field, unsigned int scr_ix) {
+	switch (scr_ix) {
+	case 0:
+		paginator_init(field, TXT_POLICY_ACCOUNT, TEXT_LINE_WIDTH);
+		number_value(field, "Account %u", policy_account_path()[2] & ~BIP32_HARDENED);
+		break;
+
+	case 1:
+		paginator_init(field, TXT_POLICY_MAX_VALUE, AMOUNT_LINE_WIDTH);
+		amount_value(field, policy_max_value());
+		break;
+
+	case 2:
+		paginator_init(field, TXT_POLICY_BUDGET, AMOUNT_LINE_WIDTH);
+		amount_value(field, policy_budget());
+		break;
+
+	case 3:
+		paginator_init(field, TXT_POLICY_VALID_FOR, TEXT_LINE_WIDTH);
+		if (policy_minutes() == 0) {
+			text_value(field, TXT_POLICY_SESSION, strlen(TXT_POLICY_SESSION));
+		} else {
+			number_value(field, "%u min", policy_minutes());
 		}
-		scr_ix++;
+		break;
+
+	default:
+		paginator_init(field, TXT_POLICY_RECIPIENT, ADDRESS_LINE_WIDTH);
+		// there are at most MAX_POLICY_RECIPIENTS, so the number fits in an unsigned char, and the label in its buffer.
+		snprintf(field->label, sizeof(field->label), "%s %u", TXT_POLICY_RECIPIENT, (unsigned char) (scr_ix - POLICY_SUMMARY_SCREENS + 1));
+		recipient_value(field, policy_recipient(scr_ix - POLICY_SUMMARY_SCREENS));
+		break;
 	}
+}
 
-	max_scr_ix = scr_ix;
-	os_memmove(curr_tx_desc, tx_desc[curr_scr_ix], CURR_TX_DESC_LEN);
+void display_message_desc(void) {
+	display_desc(MESSAGE_SCREENS);
+}
 
-	return 1;
+/** renders the start of the message, as text if it is printable, otherwise in hex. */
+static void message_preview_screen(field_text_t * field) {
+	unsigned int preview_len;
+	const unsigned char * preview = message_preview(&preview_len);
+	bool printable = true;
+	for (unsigned int ix = 0; ix < preview_len; ix++) {
+		printable &= (preview[ix] >= 0x20) && (preview[ix] <= 0x7E);
+	}
+	paginator_init(field, TXT_MESSAGE, TEXT_LINE_WIDTH);
+	if (printable) {
+		text_value(field, (const char *) preview, preview_len);
+	} else {
+		// the same two lines as the text, half as many bytes.
+		hex_value(field, preview, min(preview_len, TEXT_LINE_WIDTH));
+	}
+}
+
+/** renders the screen of the message at scr_ix. */
+static void message_screen(field_text_t * field, unsigned int scr_ix) {
+	switch (scr_ix) {
+	case 0:
+		message_preview_screen(field);
+		break;
+
+	case 1:
+		paginator_init(field, TXT_MESSAGE_LENGTH, TEXT_LINE_WIDTH);
+		number_value(field, "%u bytes", message_length());
+		break;
+
+	case 2:
+		paginator_init(field, TXT_MESSAGE_HASH_1, TEXT_LINE_WIDTH);
+		hex_value(field, message_hash(), SHA256_HASH_LEN / 2);
+		break;
+
+	default:
+		paginator_init(field, TXT_MESSAGE_HASH_2, TEXT_LINE_WIDTH);
+		hex_value(field, message_hash() + (SHA256_HASH_LEN / 2), SHA256_HASH_LEN / 2);
+		break;
+	}
+}
+
+void display_recipient_desc(void) {
+	display_desc(RECIPIENT_SCREENS);
+}
+
+/** renders the screen of the recipient to add to the allow-list at scr_ix, its address then its label. */
+static void recipient_screen(field_text_t * field, unsigned int scr_ix) {
+	if (scr_ix == 0) {
+		paginator_init(field, TXT_POLICY_RECIPIENT, ADDRESS_LINE_WIDTH);
+		address_value(field, allow_list_request_script_hash());
+	} else {
+		paginator_init(field, TXT_RECIPIENT_LABEL, TEXT_LINE_WIDTH);
+		text_value(field, allow_list_request_label(), strlen(allow_list_request_label()));
+	}
+}
+
+void display_exit_timeout_desc(void) {
+	display_desc(EXIT_TIMEOUT_SCREENS);
+}
+
+/** renders the screen of the exit timeout to set at scr_ix, the current one then the new one. */
+static void exit_timeout_screen(field_text_t * field, unsigned int scr_ix) {
+	if (scr_ix == 0) {
+		paginator_init(field, TXT_EXIT_TIMEOUT_CURRENT, TEXT_LINE_WIDTH);
+		number_value(field, "%u seconds", settings_exit_timeout());
+	} else {
+		paginator_init(field, TXT_EXIT_TIMEOUT_NEW, TEXT_LINE_WIDTH);
+		number_value(field, "%u seconds", settings_requested_exit_timeout());
+	}
+}
+
+/** renders the screen at scr_ix of what is being reviewed into field. */
+static void render_screen(field_text_t * field, unsigned int scr_ix) {
+	switch (review_type) {
+	case REVIEW_BATCH:
+		batch_screen(field, scr_ix);
+		break;
+	case REVIEW_POLICY:
+		policy_screen(field, scr_ix);
+		break;
+	case REVIEW_MESSAGE:
+		message_screen(field, scr_ix);
+		break;
+	case REVIEW_RECIPIENT:
+		recipient_screen(field, scr_ix);
+		break;
+	case REVIEW_EXIT_TIMEOUT:
+		exit_timeout_screen(field, scr_ix);
+		break;
+	default:
+		tx_field_screen(field, scr_ix);
+		break;
+	}
+}
+
+unsigned int load_tx_desc_screen(unsigned int scr_ix) {
+	scratch_begin(SCRATCH_RENDER);
+	render_screen(&curr_field, scr_ix);
+#if defined(TARGET_NANOX)
+	return paginator_step_count(&curr_field, TX_DESC_PAGE_LINES - 1);
+#else // TARGET_NANOX
+	return paginator_page_count(&curr_field, TX_DESC_PAGE_LINES);
+#endif // TARGET_NANOX
+}
+
+void load_tx_desc_page(unsigned int page_ix) {
+#if defined(TARGET_NANOX)
+	paginator_step(&curr_field, page_ix, TX_DESC_PAGE_LINES - 1, curr_tx_desc);
+#else // TARGET_NANOX
+	paginator_page(&curr_field, page_ix, TX_DESC_PAGE_LINES, curr_tx_desc);
+#endif // TARGET_NANOX
 }
 
 void display_no_public_key() {
@@ -547,55 +964,42 @@ void display_no_public_key() {
 }
 
 void public_key_hash160(unsigned char * in, unsigned short inlen, unsigned char *out) {
+	// the SHA-256 context is done with before the RIPEMD-160 one starts, so they share the allocation.
+	const unsigned int mark = scratch_mark();
 	union {
 		cx_sha256_t shasha;
 		cx_ripemd160_t riprip;
-	} u;
-	unsigned char buffer[SHA256_HASH_LEN];
-	cx_sha256_init(&u.shasha);
-	cx_hash(&u.shasha.header, CX_LAST, in, inlen, buffer, sizeof(buffer));
-	cx_ripemd160_init(&u.riprip);
-	cx_hash(&u.riprip.header, CX_LAST, buffer, sizeof(buffer), out, 20);
+	} * u = scratch_alloc(sizeof(*u));
+	unsigned char * buffer = scratch_alloc(SHA256_HASH_LEN);
+	cx_sha256_init(&u->shasha);
+	cx_hash(&u->shasha.header, CX_LAST, in, inlen, buffer, SHA256_HASH_LEN);
+	cx_ripemd160_init(&u->riprip);
+	cx_hash(&u->riprip.header, CX_LAST, buffer, SHA256_HASH_LEN, out, 20);
+	scratch_release(mark);
 }
 
-void display_public_key(const unsigned char * public_key) {
-	os_memmove(current_public_key[0], TXT_BLANK, sizeof(TXT_BLANK));
-	os_memmove(current_public_key[1], TXT_BLANK, sizeof(TXT_BLANK));
-	os_memmove(current_public_key[2], TXT_BLANK, sizeof(TXT_BLANK));
-
+void public_key_script_hash(const unsigned char * public_key, unsigned char * script_hash) {
 	//compress public key
-	// from https://github.com/CityOfZion/neon-js core.js
-	unsigned char public_key_encoded[33];
-	public_key_encoded[0] = ((public_key[64] & 1) ? 0x03 : 0x02);
-	os_memmove(public_key_encoded + 1, public_key + 1, 32);
+	unsigned char public_key_encoded[COMPRESSED_PUBLIC_KEY_LEN];
+	compress_public_key(public_key, public_key_encoded);
 
 	unsigned char verification_script[35];
 	verification_script[0] = 0x21;
 	os_memmove(verification_script + 1, public_key_encoded, sizeof(public_key_encoded));
 	verification_script[sizeof(verification_script) - 1] = 0xAC;
 
-	unsigned char script_hash[SCRIPT_HASH_LEN];
-	for (int i = 0; i < SCRIPT_HASH_LEN; i++) {
-		script_hash[i] = 0x00;
-	}
-
 	public_key_hash160(verification_script, sizeof(verification_script), script_hash);
-	unsigned char script_hash_rev[SCRIPT_HASH_LEN];
-	for (int i = 0; i < SCRIPT_HASH_LEN; i++) {
-		script_hash_rev[i] = script_hash[SCRIPT_HASH_LEN - (i + 1)];
-	}
-
-	char address_base58[ADDRESS_BASE58_LEN];
-	unsigned int address_base58_len_0 = 12;
-	unsigned int address_base58_len_1 = 11;
-	unsigned int address_base58_len_2 = 12;
-	char * address_base58_0 = address_base58;
-	char * address_base58_1 = address_base58 + address_base58_len_0;
-	char * address_base58_2 = address_base58 + address_base58_len_0 + address_base58_len_1;
+}
 
-	to_address(address_base58, ADDRESS_BASE58_LEN, script_hash);
+void display_public_key(const unsigned char * public_key) {
+	scratch_begin(SCRATCH_RENDER);
+	unsigned char script_hash[SCRIPT_HASH_LEN];
+	public_key_script_hash(public_key, script_hash);
 
-	os_memmove(current_public_key[0], address_base58_0, address_base58_len_0);
-	os_memmove(current_public_key[1], address_base58_1, address_base58_len_1);
-	os_memmove(current_public_key[2], address_base58_2, address_base58_len_2);
+	field_text_t field;
+	paginator_init(&field, TXT_ADDRESS, ADDRESS_LINE_WIDTH);
+	address_value(&field, script_hash);
+	for (unsigned int ix = 0; ix < MAX_TX_TEXT_LINES; ix++) {
+		paginator_line(&field, ix, current_public_key[ix]);
+	}
 }
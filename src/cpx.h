@@ -11,14 +11,57 @@
 #include "os_io_seproxyhal.h"
 #include "ui.h"
 #include "sha256_hash_len.h"
+#include "uint256.h"
 
+/** length of tx.output.script_hash */
+#define SCRIPT_HASH_LEN 20
 
-/** parse the raw transaction in raw_tx and fill up the screens in tx_desc. */
+/** what a transaction does, as kept for each transaction of a batch. */
+typedef struct {
+	/** script hash of the recipient. */
+	unsigned char to[SCRIPT_HASH_LEN];
+	/** value sent. */
+	uint256_t value;
+	/** fee paid. */
+	uint256_t fee;
+} tx_summary_t;
+
+/** parse the raw transaction in raw_tx into the list of fields to display, and render the first screen. */
 unsigned char display_tx_desc(void);
 
+/** converts a big endian number of length bytes, up to 32, into target. */
+void convertUint256BE(uint8_t *data, uint32_t length, uint256_t *target);
+
+/** parse the transfer in raw_tx into its summary, returns false if it is not a transfer. */
+bool parse_tx_summary(tx_summary_t * summary);
+
+/** set up the batch summary screens, then the screens of each transaction of the batch, and render the first screen. */
+void display_batch_desc(void);
+
+/** set up the spending policy screens, and render the first screen. */
+void display_policy_desc(void);
+
+/** set up the screens of the message being signed, and render the first screen. */
+void display_message_desc(void);
+
+/** set up the screens of the recipient to add to the allow-list, and render the first screen. */
+void display_recipient_desc(void);
+
+/** set up the screens of the exit timeout to set, and render the first screen. */
+void display_exit_timeout_desc(void);
+
+/** renders the screen at scr_ix, and returns its number of pages, on Nano X its number of flow steps. */
+unsigned int load_tx_desc_screen(unsigned int scr_ix);
+
+/** copies the page at page_ix of the screen rendered by load_tx_desc_screen into curr_tx_desc. */
+void load_tx_desc_page(unsigned int page_ix);
+
 /** displays the "no public key" message, prior to a public key being requested. */
 void display_no_public_key(void);
 
+/** computes the script hash of the verification script of the public key, assumes length is 65. */
+void public_key_script_hash(const unsigned char * public_key, unsigned char * script_hash);
+
 /** displays the public key, assumes length is 65. */
 void display_public_key(const unsigned char * public_key);
 
@@ -0,0 +1,227 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "keys.h"
+#include "call_counts.h"
+
+/** order of the secp256r1 curve. */
+static const unsigned char SECP256R1_ORDER[32] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xBC,
+		0xE6, 0xFA, 0xAD, 0xA7, 0x17, 0x9E, 0x84, 0xF3, 0xB9, 0xCA, 0xC2, 0xFC, 0x63, 0x25, 0x51 };
+
+/** the account node m/44'/888'/account', kept while the app is open, so the keys under it only need two child derivations. */
+static struct {
+	bool valid;
+	unsigned int account_path[ACCOUNT_PATH_LEN];
+	unsigned char privateKeyData[32];
+	unsigned char chainCode[CHAIN_CODE_LEN];
+	unsigned char publicKey[COMPRESSED_PUBLIC_KEY_LEN];
+} account_node;
+
+/** state of the signing key. */
+enum SIGNING_KEY_STATE {
+	SIGNING_KEY_NONE, SIGNING_KEY_PENDING, SIGNING_KEY_READY
+};
+
+/**
+ * the private key of the path being signed.
+ * derived ahead of time while the user reviews the transaction, and with HAVE_SESSION_KEY_CACHE kept for the session.
+ */
+static struct {
+	enum SIGNING_KEY_STATE state;
+	unsigned int bip44_path[BIP44_PATH_LEN];
+	cx_ecfp_private_key_t privateKey;
+} signing_key;
+
+void read_bip32_path(const unsigned char * bip32_in, unsigned int * bip32_path, unsigned int path_len) {
+	for (uint32_t i = 0; i < path_len; i++) {
+		bip32_path[i] = (((unsigned int) bip32_in[0]) << 24) | (bip32_in[1] << 16) | (bip32_in[2] << 8) | (bip32_in[3]);
+		bip32_in += 4;
+	}
+}
+
+void read_bip44_path(const unsigned char * bip44_in, unsigned int * bip44_path) {
+	read_bip32_path(bip44_in, bip44_path, BIP44_PATH_LEN);
+}
+
+bool is_account_path(const unsigned int * bip32_path) {
+	return (bip32_path[0] == BIP44_PURPOSE) && (bip32_path[1] == BIP44_COIN_TYPE) && ((bip32_path[2] & BIP32_HARDENED) != 0);
+}
+
+/** generates the compressed public key of the private key data. */
+static void compressed_public_key_of(const unsigned char * privateKeyData, unsigned char * public_key_encoded) {
+	cx_ecfp_private_key_t privateKey;
+	cx_ecfp_public_key_t publicKey;
+
+	cx_ecdsa_init_private_key(CX_CURVE_256R1, privateKeyData, 32, &privateKey);
+	cx_ecdsa_init_public_key(CX_CURVE_256R1, NULL, 0, &publicKey);
+	cx_ecfp_generate_pair(CX_CURVE_256R1, &publicKey, &privateKey, 1);
+	clear_private_key(&privateKey);
+
+	compress_public_key(publicKey.W, public_key_encoded);
+}
+
+/**
+ * replaces the node (private key data and chain code) by its non-hardened child at index.
+ * publicKey is the compressed public key of the node.
+ * follows SLIP-0010, which is BIP32 with a retry when the child key is not valid on the curve.
+ */
+static void derive_child_node(unsigned char * privateKeyData, unsigned char * chainCode, const unsigned char * publicKey, unsigned int index) {
+	unsigned char data[COMPRESSED_PUBLIC_KEY_LEN + 4];
+	unsigned char I[64];
+	unsigned char childKeyData[32];
+
+	os_memmove(data, publicKey, COMPRESSED_PUBLIC_KEY_LEN);
+	data[COMPRESSED_PUBLIC_KEY_LEN + 0] = index >> 24;
+	data[COMPRESSED_PUBLIC_KEY_LEN + 1] = index >> 16;
+	data[COMPRESSED_PUBLIC_KEY_LEN + 2] = index >> 8;
+	data[COMPRESSED_PUBLIC_KEY_LEN + 3] = index;
+
+	for (;;) {
+		cx_hmac_sha512(chainCode, CHAIN_CODE_LEN, data, sizeof(data), I, sizeof(I));
+		if (cx_math_cmp(I, SECP256R1_ORDER, 32) < 0) {
+			cx_math_addm(childKeyData, I, privateKeyData, SECP256R1_ORDER, 32);
+			if (!cx_math_is_zero(childKeyData, 32)) {
+				break;
+			}
+		}
+		// not a valid key, try again with 0x01 || IR || index.
+		data[0] = 0x01;
+		os_memmove(data + 1, I + 32, 32);
+	}
+
+	os_memmove(privateKeyData, childKeyData, 32);
+	os_memmove(chainCode, I + 32, CHAIN_CODE_LEN);
+
+	memset(I, 0x00, sizeof(I));
+	memset(childKeyData, 0x00, sizeof(childKeyData));
+}
+
+/** makes sure account_node holds the account node of the BIP44 path. */
+static void load_account_node(const unsigned int * bip44_path) {
+	if (account_node.valid && (os_memcmp(account_node.account_path, bip44_path, ACCOUNT_PATH_BYTE_LENGTH) == 0)) {
+		return;
+	}
+	account_node.valid = false;
+	COUNT_CALL(CALL_COUNT_DERIVE_NODE);
+	os_perso_derive_node_bip32(CX_CURVE_256R1, bip44_path, ACCOUNT_PATH_LEN, account_node.privateKeyData, account_node.chainCode);
+	compressed_public_key_of(account_node.privateKeyData, account_node.publicKey);
+	os_memmove(account_node.account_path, bip44_path, ACCOUNT_PATH_BYTE_LENGTH);
+	account_node.valid = true;
+}
+
+/**
+ * derives the private key data of the BIP44 path.
+ * if the change and address index levels are not hardened, derives them in the app from the cached account node,
+ * otherwise derives all levels from the seed.
+ */
+static void derive_bip44_private_key_data(const unsigned int * bip44_path, unsigned char * privateKeyData) {
+	if (!is_account_path(bip44_path) || (((bip44_path[3] | bip44_path[4]) & BIP32_HARDENED) != 0)) {
+		COUNT_CALL(CALL_COUNT_DERIVE_NODE);
+		os_perso_derive_node_bip32(CX_CURVE_256R1, bip44_path, BIP44_PATH_LEN, privateKeyData, NULL);
+		return;
+	}
+
+	load_account_node(bip44_path);
+
+	unsigned char chainCode[CHAIN_CODE_LEN];
+	unsigned char publicKey[COMPRESSED_PUBLIC_KEY_LEN];
+	os_memmove(privateKeyData, account_node.privateKeyData, 32);
+	os_memmove(chainCode, account_node.chainCode, CHAIN_CODE_LEN);
+
+	// change level.
+	derive_child_node(privateKeyData, chainCode, account_node.publicKey, bip44_path[3]);
+
+	// address index level.
+	compressed_public_key_of(privateKeyData, publicKey);
+	derive_child_node(privateKeyData, chainCode, publicKey, bip44_path[4]);
+
+	memset(chainCode, 0x00, sizeof(chainCode));
+}
+
+void derive_node_public_key(const unsigned int * bip32_path, unsigned int path_len, cx_ecfp_public_key_t * publicKey, unsigned char * chainCode) {
+	cx_ecfp_private_key_t privateKey;
+	unsigned char privateKeyData[32];
+
+	COUNT_CALL(CALL_COUNT_DERIVE_NODE);
+	os_perso_derive_node_bip32(CX_CURVE_256R1, bip32_path, path_len, privateKeyData, chainCode);
+	cx_ecdsa_init_private_key(CX_CURVE_256R1, privateKeyData, 32, &privateKey);
+
+	// generate the public key.
+	cx_ecdsa_init_public_key(CX_CURVE_256R1, NULL, 0, publicKey);
+	cx_ecfp_generate_pair(CX_CURVE_256R1, publicKey, &privateKey, 1);
+
+	// clear private key data
+	cx_ecdsa_init_private_key(CX_CURVE_256R1, NULL, 0, &privateKey);
+	memset(privateKeyData, 0x00, sizeof(privateKeyData));
+}
+
+void derive_public_key(const unsigned int * bip44_path, cx_ecfp_public_key_t * publicKey) {
+	cx_ecfp_private_key_t privateKey;
+	unsigned char privateKeyData[32];
+
+	derive_bip44_private_key_data(bip44_path, privateKeyData);
+	cx_ecdsa_init_private_key(CX_CURVE_256R1, privateKeyData, 32, &privateKey);
+
+	// generate the public key.
+	cx_ecdsa_init_public_key(CX_CURVE_256R1, NULL, 0, publicKey);
+	cx_ecfp_generate_pair(CX_CURVE_256R1, publicKey, &privateKey, 1);
+
+	// clear private key data
+	clear_private_key(&privateKey);
+	memset(privateKeyData, 0x00, sizeof(privateKeyData));
+}
+
+void prepare_private_key(const unsigned int * bip44_path) {
+	if ((signing_key.state == SIGNING_KEY_READY) && (os_memcmp(signing_key.bip44_path, bip44_path, BIP44_BYTE_LENGTH) == 0)) {
+		return;
+	}
+	signing_key_wipe();
+	os_memmove(signing_key.bip44_path, bip44_path, BIP44_BYTE_LENGTH);
+	signing_key.state = SIGNING_KEY_PENDING;
+}
+
+bool derive_prepared_private_key(void) {
+	if (signing_key.state != SIGNING_KEY_PENDING) {
+		return false;
+	}
+	unsigned char privateKeyData[32];
+	derive_bip44_private_key_data(signing_key.bip44_path, privateKeyData);
+	cx_ecdsa_init_private_key(CX_CURVE_256R1, privateKeyData, 32, &signing_key.privateKey);
+	memset(privateKeyData, 0x00, sizeof(privateKeyData));
+	signing_key.state = SIGNING_KEY_READY;
+	return true;
+}
+
+void derive_private_key(const unsigned int * bip44_path, cx_ecfp_private_key_t * privateKey) {
+	// derive now, unless it was already done while the user was reviewing (or earlier in the session).
+	prepare_private_key(bip44_path);
+	derive_prepared_private_key();
+	os_memmove(privateKey, &signing_key.privateKey, sizeof(cx_ecfp_private_key_t));
+}
+
+void release_private_key(cx_ecfp_private_key_t * privateKey) {
+	clear_private_key(privateKey);
+#ifndef HAVE_SESSION_KEY_CACHE
+	signing_key_wipe();
+#endif // HAVE_SESSION_KEY_CACHE
+}
+
+void clear_private_key(cx_ecfp_private_key_t * privateKey) {
+	cx_ecdsa_init_private_key(CX_CURVE_256R1, NULL, 0, privateKey);
+	os_memset(privateKey, 0x00, sizeof(cx_ecfp_private_key_t));
+}
+
+void signing_key_wipe(void) {
+	os_memset(&signing_key, 0x00, sizeof(signing_key));
+}
+
+void session_keys_wipe(void) {
+	signing_key_wipe();
+	os_memset(&account_node, 0x00, sizeof(account_node));
+}
+
+void compress_public_key(const unsigned char * public_key, unsigned char * public_key_encoded) {
+	// from https://github.com/CityOfZion/neon-js core.js
+	public_key_encoded[0] = ((public_key[64] & 1) ? 0x03 : 0x02);
+	os_memmove(public_key_encoded + 1, public_key + 1, 32);
+}
@@ -0,0 +1,71 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef KEYS_H
+#define KEYS_H
+
+#include "os.h"
+#include "cx.h"
+#include "ui.h"
+
+/** length of a compressed public key. */
+#define COMPRESSED_PUBLIC_KEY_LEN 33
+
+/** length of a BIP32 chain code. */
+#define CHAIN_CODE_LEN 32
+
+/** hardened BIP44 purpose, 44' */
+#define BIP44_PURPOSE 0x8000002C
+
+/** hardened BIP44 coin type of CPX, 888' */
+#define BIP44_COIN_TYPE 0x80000378
+
+/** flag of a hardened BIP32 index */
+#define BIP32_HARDENED 0x80000000
+
+/** reads path_len big endian integers from bip32_in into bip32_path. */
+void read_bip32_path(const unsigned char * bip32_in, unsigned int * bip32_path, unsigned int path_len);
+
+/** reads BIP44_PATH_LEN big endian integers from bip44_in into bip44_path. */
+void read_bip44_path(const unsigned char * bip44_in, unsigned int * bip44_path);
+
+/** returns true if the path is m/44'/888'/account' */
+bool is_account_path(const unsigned int * bip32_path);
+
+/** derives the private key (and chain code, if not NULL) for the given BIP32 path, and generates the matching public key. */
+void derive_node_public_key(const unsigned int * bip32_path, unsigned int path_len, cx_ecfp_public_key_t * publicKey, unsigned char * chainCode);
+
+/**
+ * derives the private key for the given BIP44 path, and generates the matching public key.
+ * the account node is kept for the session, so the keys of other addresses of the account only need two child derivations.
+ */
+void derive_public_key(const unsigned int * bip44_path, cx_ecfp_public_key_t * publicKey);
+
+/** schedules the derivation of the signing key of the BIP44 path, done by derive_prepared_private_key while the device is idle. */
+void prepare_private_key(const unsigned int * bip44_path);
+
+/** derives the signing key scheduled by prepare_private_key, returns false if there was nothing to do. */
+bool derive_prepared_private_key(void);
+
+/**
+ * returns the private key for the given BIP44 path, deriving it unless it was prepared ahead of time.
+ * with HAVE_SESSION_KEY_CACHE, the key of the last path is kept for the session, so signing again with the same path skips the derivation.
+ */
+void derive_private_key(const unsigned int * bip44_path, cx_ecfp_private_key_t * privateKey);
+
+/** clears a private key returned by derive_private_key, after signing. */
+void release_private_key(cx_ecfp_private_key_t * privateKey);
+
+/** clears a private key. */
+void clear_private_key(cx_ecfp_private_key_t * privateKey);
+
+/** forgets the signing key, prepared or kept for the session. */
+void signing_key_wipe(void);
+
+/** forgets the account node and signing key kept for the session. */
+void session_keys_wipe(void);
+
+/** compresses the 65 byte public key into the 33 byte public_key_encoded. */
+void compress_public_key(const unsigned char * public_key, unsigned char * public_key_encoded);
+
+#endif // KEYS_H
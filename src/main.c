@@ -22,41 +22,81 @@
 #include "ui.h"
 #include "bagl.h"
 #include "cpx.h"
-
-#define MAX_EXIT_TIMER 4098
-
-#define EXIT_TIMER_REFRESH_INTERVAL 512
-
-static void Timer_UpdateDescription() {
-	snprintf(timer_desc, MAX_TIMER_TEXT_WIDTH, "%d", exit_timer / EXIT_TIMER_REFRESH_INTERVAL);
+#include "keys.h"
+#include "signature_cache.h"
+#include "batch.h"
+#include "policy.h"
+#include "message.h"
+#include "settings.h"
+#include "scratch.h"
+#include "audit_log.h"
+#include "allow_list.h"
+#include "call_counts.h"
+#include "stack_usage.h"
+#include "trace.h"
+#ifdef HOST_BUILD
+#include "host.h"
+#endif // HOST_BUILD
+
+/** number of ticker events per second, there is one every 100 ms. */
+#define TICKS_PER_SECOND 10
+
+/** number of ticker events since the app started. */
+static unsigned int ticks;
+
+/** tick at which the app exits, unless there is activity before. */
+static unsigned int exit_deadline;
+
+/** tick at which the remaining seconds in exit_timer go down next. */
+static unsigned int next_timer_update;
+
+/** the exit timeout from the settings, at most MAX_EXIT_TIMEOUT seconds, so it fits in timer_desc. */
+static unsigned int Timer_ExitTimeout() {
+	const unsigned int exit_timeout = settings_exit_timeout();
+	return (exit_timeout < MAX_EXIT_TIMEOUT) ? exit_timeout : MAX_EXIT_TIMEOUT;
 }
 
-static void Timer_UpdateDisplay() {
-	if ((exit_timer % EXIT_TIMER_REFRESH_INTERVAL) == (EXIT_TIMER_REFRESH_INTERVAL / 2)) {
-		UX_REDISPLAY();
-	}
+static void Timer_UpdateDescription() {
+	// exit_timer never exceeds MAX_EXIT_TIMEOUT, the bound lets the compiler prove the digits fit.
+	const unsigned int seconds = (exit_timer < MAX_EXIT_TIMEOUT) ? exit_timer : MAX_EXIT_TIMEOUT;
+	snprintf(timer_desc, MAX_TIMER_TEXT_WIDTH, "%u", seconds);
 }
 
+/** counts a ticker event. only does more work once a second, when the remaining seconds go down. */
 static void Timer_Tick() {
+	ticks++;
+	if (ticks < next_timer_update) {
+		return;
+	}
+	next_timer_update += TICKS_PER_SECOND;
 	if (exit_timer > 0) {
 		exit_timer--;
 		Timer_UpdateDescription();
 	}
 }
 
+/** starts the timer over, with the exit timeout from the settings. */
 static void Timer_Set() {
-	exit_timer = MAX_EXIT_TIMER;
+	const unsigned int exit_timeout = Timer_ExitTimeout();
+	exit_deadline = ticks + (exit_timeout * TICKS_PER_SECOND);
+	next_timer_update = ticks + TICKS_PER_SECOND;
+	exit_timer = exit_timeout;
 	Timer_UpdateDescription();
 }
 
+/** pushes the deadline back after activity, the description is only rendered again if the remaining seconds changed. */
 static void Timer_Restart() {
-	if (exit_timer != MAX_EXIT_TIMER) {
-		Timer_Set();
+	const unsigned int exit_timeout = Timer_ExitTimeout();
+	exit_deadline = ticks + (exit_timeout * TICKS_PER_SECOND);
+	next_timer_update = ticks + TICKS_PER_SECOND;
+	if (exit_timer != exit_timeout) {
+		exit_timer = exit_timeout;
+		Timer_UpdateDescription();
 	}
 }
 
 static bool Timer_Expired() {
-	return exit_timer <= 0;
+	return ticks >= exit_deadline;
 }
 
 /** IO buffer to communicate with the outside world. */
@@ -72,6 +112,42 @@ unsigned char G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
 /** instruction to send back the public key. */
 #define INS_GET_PUBLIC_KEY 0x04
 
+/** instruction to send back the public keys (or script hashes) of a range of consecutive address indices. */
+#define INS_GET_PUBLIC_KEY_BATCH 0x06
+
+/** instruction to send back the public key and chain code of an account, after user confirmation. */
+#define INS_GET_EXTENDED_PUBLIC_KEY 0x08
+
+/** instruction to queue transactions, review them all at once, and send back their signatures. */
+#define INS_SIGN_BATCH 0x0A
+
+/** instruction to set a spending policy, after user confirmation, under which transfers are signed without review. */
+#define INS_SET_SPENDING_POLICY 0x0C
+
+/** instruction to sign a message of any size, hashed as its parts arrive, after user confirmation. */
+#define INS_SIGN_MESSAGE 0x0E
+
+/** instruction to set the time without activity after which the app exits, kept in NVRAM, after user confirmation. */
+#define INS_SET_EXIT_TIMEOUT 0x10
+
+/** instruction to send back a page of the audit log of signed transactions, newest first. */
+#define INS_GET_AUDIT_LOG 0x12
+
+/** instruction to add a recipient with a label to the allow-list in NVRAM, after user confirmation. */
+#define INS_ADD_RECIPIENT 0x14
+
+/** instruction to send back the call counts of the hot paths, and reset them if P1 is P1_CALL_COUNTS_RESET, with HAVE_CALL_COUNTS. */
+#define INS_GET_CALL_COUNTS 0x16
+
+/** for the call counts, indicates they are reset once sent. */
+#define P1_CALL_COUNTS_RESET 0x01
+
+/** instruction to send back the size of the stack, the deepest it was used since startup, and its free room now. */
+#define INS_GET_STACK_USAGE 0x18
+
+/** instruction to send back the oldest events of the trace and forget them, with HAVE_TRACE. */
+#define INS_GET_TRACE 0x1A
+
 /** #### instructions end #### */
 
 /** some kind of event loop */
@@ -102,6 +178,262 @@ unsigned short io_exchange_al(unsigned char channel, unsigned short tx_len) {
 	return 0;
 }
 
+/**
+ * looks up the signatures of tx_hash with each of the sign_path_count BIP44 paths in the signature cache,
+ * and writes them into the response buffer the same way io_seproxyhal_touch_approve does.
+ * returns the length of the response, or 0 if any of them was not signed in this session.
+ */
+static unsigned int get_cached_signatures(void) {
+	const bool multi_path = (G_io_apdu_buffer[3] == P2_MULTI_PATH);
+	unsigned int bip44_path[BIP44_PATH_LEN];
+	unsigned int tx = 0;
+
+	for (unsigned int path_ix = 0; path_ix < sign_path_count; path_ix++) {
+		read_bip44_path(raw_tx + raw_tx_body_len + (path_ix * BIP44_BYTE_LENGTH), bip44_path);
+		unsigned char * out = G_io_apdu_buffer + tx + (multi_path ? 1 : 0);
+		unsigned int signature_len = signature_cache_get(tx_hash, bip44_path, out);
+		if (signature_len == 0) {
+			return 0;
+		}
+		if (multi_path) {
+			G_io_apdu_buffer[tx++] = signature_len;
+		}
+		tx += signature_len;
+	}
+	return tx;
+}
+
+/** for public key batches, return compressed public keys. */
+#define P2_BATCH_PUBLIC_KEY 0x00
+
+/** for public key batches, return script hashes. */
+#define P2_BATCH_SCRIPT_HASH 0x01
+
+/** length of a public key batch request, the BIP44 path (last element is the start index) followed by the count. */
+#define BATCH_REQUEST_LENGTH (BIP44_BYTE_LENGTH + 1)
+
+/**
+ * derives the public keys of count consecutive address indices, starting at the last element of the BIP44 path.
+ * writes the count that fit into the response buffer, followed by each compressed public key or script hash.
+ * returns the length of the response.
+ */
+static unsigned int get_public_key_batch(void) {
+	cx_ecfp_public_key_t publicKey;
+	unsigned int entry_len;
+
+	switch (G_io_apdu_buffer[3]) {
+	case P2_BATCH_PUBLIC_KEY:
+		entry_len = COMPRESSED_PUBLIC_KEY_LEN;
+		break;
+	case P2_BATCH_SCRIPT_HASH:
+		entry_len = SCRIPT_HASH_LEN;
+		break;
+	default:
+		hashTainted = 1;
+		THROW(0x6A86);
+	}
+
+	if (get_apdu_buffer_length() < BATCH_REQUEST_LENGTH) {
+		hashTainted = 1;
+		THROW(0x6D15);
+	}
+
+	unsigned int bip44_path[BIP44_PATH_LEN];
+	read_bip44_path(G_io_apdu_buffer + APDU_HEADER_LENGTH, bip44_path);
+	unsigned int count = G_io_apdu_buffer[APDU_HEADER_LENGTH + BIP44_BYTE_LENGTH];
+
+	// pack as many keys as the response buffer allows (leaving room for the count and the status word), the host asks again for the rest.
+	unsigned int max_count = (sizeof(G_io_apdu_buffer) - 3) / entry_len;
+	if (count > max_count) {
+		count = max_count;
+	}
+
+	// the range can't be empty or cross from non-hardened into hardened indices.
+	const unsigned int start_index = bip44_path[BIP44_PATH_LEN - 1];
+	const unsigned int last_index = start_index + count - 1;
+	if ((count == 0) || (last_index < start_index) || ((last_index ^ start_index) & BIP32_HARDENED)) {
+		hashTainted = 1;
+		THROW(0x6D16);
+	}
+
+	scratch_begin(SCRATCH_SIGN);
+	unsigned int tx = 0;
+	G_io_apdu_buffer[tx++] = count;
+	for (unsigned int i = 0; i < count; i++) {
+		bip44_path[BIP44_PATH_LEN - 1] = start_index + i;
+		derive_public_key(bip44_path, &publicKey);
+		if (entry_len == COMPRESSED_PUBLIC_KEY_LEN) {
+			compress_public_key(publicKey.W, G_io_apdu_buffer + tx);
+		} else {
+			public_key_script_hash(publicKey.W, G_io_apdu_buffer + tx);
+		}
+		tx += entry_len;
+	}
+	return tx;
+}
+
+/** instruction whose transaction parts are in raw_tx. */
+static unsigned char raw_tx_ins;
+
+/** returns true if the APDU is the first part, as the last one was done or was part of another instruction, and takes over the hash for the instruction. */
+static bool is_first_chunk(void) {
+	if (hashTainted || (raw_tx_ins != G_io_apdu_buffer[1])) {
+		hashTainted = 0;
+		raw_tx_ins = G_io_apdu_buffer[1];
+		return true;
+	}
+	return false;
+}
+
+/**
+ * appends the body of the APDU to raw_tx. the first part (or a part of another instruction) restarts the hash and raw_tx.
+ * with the last part, sets raw_tx_len and rewinds raw_tx_ix, ready for parsing.
+ */
+static void append_raw_tx_chunk(void) {
+	// check the third byte (0x02) for the instruction subtype.
+	if ((G_io_apdu_buffer[2] != P1_MORE) && (G_io_apdu_buffer[2] != P1_LAST)) {
+		hashTainted = 1;
+		THROW(0x6A86);
+	}
+
+	scratch_begin(SCRATCH_UPLOAD);
+
+	// if this is the first transaction part, reset the hash and all the other temporary variables.
+	if (is_first_chunk()) {
+		cx_sha256_init(&hash);
+		raw_tx_ix = 0;
+		raw_tx_len = 0;
+	}
+
+	// move the contents of the buffer into raw_tx, and update raw_tx_ix to the end of the buffer, to be ready for the next part of the tx.
+	unsigned int len = get_apdu_buffer_length();
+	unsigned char * in = G_io_apdu_buffer + APDU_HEADER_LENGTH;
+	unsigned char * out = raw_tx + raw_tx_ix;
+	if (raw_tx_ix + len > MAX_TX_RAW_LENGTH) {
+		hashTainted = 1;
+		THROW(0x6D08);
+	}
+	os_memmove(out, in, len);
+	raw_tx_ix += len;
+	TRACE(TRACE_CHUNK, raw_tx_ix);
+
+	// set the screen to be the first screen.
+	curr_scr_ix = 0;
+
+	// set the buffer to end with a zero, unless the body fills it.
+	if (APDU_HEADER_LENGTH + len < sizeof(G_io_apdu_buffer)) {
+		G_io_apdu_buffer[APDU_HEADER_LENGTH + len] = '\0';
+	}
+
+	if (G_io_apdu_buffer[2] == P1_LAST) {
+		raw_tx_len = raw_tx_ix;
+		raw_tx_ix = 0;
+	}
+}
+
+/** for batches, the APDU is a part of a transaction to add to the batch, followed by its BIP44 path in the last part. */
+#define P2_BATCH_ADD 0x00
+
+/** for batches, display the batch summary for review. */
+#define P2_BATCH_REVIEW 0x01
+
+/** for batches, send back the signature of the transaction at the index in the APDU body, once the batch is approved. */
+#define P2_BATCH_GET_SIGNATURE 0x02
+
+/**
+ * handles the batch instruction, returns the length of the response.
+ * the review is the only asynchronous one, its response is sent when the user approves or denies the batch.
+ */
+static unsigned int sign_batch(volatile unsigned int * flags) {
+	unsigned int tx = 0;
+
+	switch (G_io_apdu_buffer[3]) {
+	case P2_BATCH_ADD:
+		// the batch can't change while it is displayed.
+		if (is_reviewing_tx()) {
+			hashTainted = 1;
+			THROW(0x6D1E);
+		}
+		append_raw_tx_chunk();
+		if (G_io_apdu_buffer[2] == P1_LAST) {
+			scratch_begin(SCRATCH_PARSE);
+			G_io_apdu_buffer[tx++] = batch_add_tx();
+		}
+		break;
+
+	case P2_BATCH_REVIEW:
+		if (batch_tx_count() == 0) {
+			THROW(0x6D1D);
+		}
+		review_type = REVIEW_BATCH;
+		curr_scr_ix = 0;
+		display_batch_desc();
+		ui_top_sign_batch();
+		*flags |= IO_ASYNCH_REPLY;
+		break;
+
+	case P2_BATCH_GET_SIGNATURE:
+		if (get_apdu_buffer_length() < 1) {
+			THROW(0x6D1E);
+		}
+		tx = batch_sign(G_io_apdu_buffer[APDU_HEADER_LENGTH], G_io_apdu_buffer, sizeof(G_io_apdu_buffer) - 2);
+		break;
+
+	default:
+		THROW(0x6A86);
+	}
+	return tx;
+}
+
+/**
+ * hashes the part of the message in the APDU, the first part starts with the BIP44 path to sign with.
+ * once the last part arrives, displays the message for review, otherwise returns right away so the next part can be sent.
+ */
+static void sign_message(volatile unsigned int * flags) {
+	// check the third byte (0x02) for the instruction subtype.
+	if ((G_io_apdu_buffer[2] != P1_MORE) && (G_io_apdu_buffer[2] != P1_LAST)) {
+		hashTainted = 1;
+		THROW(0x6A86);
+	}
+
+	// the screens can't change while a review is displayed.
+	if (is_reviewing_tx()) {
+		hashTainted = 1;
+		THROW(0x6D1E);
+	}
+
+	scratch_begin(SCRATCH_UPLOAD);
+	unsigned int len = get_apdu_buffer_length();
+	unsigned char * in = G_io_apdu_buffer + APDU_HEADER_LENGTH;
+	if (is_first_chunk()) {
+		message_start(in, len);
+	} else {
+		message_append(in, len);
+	}
+
+	if (G_io_apdu_buffer[2] == P1_LAST) {
+		message_finish();
+
+		review_type = REVIEW_MESSAGE;
+		curr_scr_ix = 0;
+		display_message_desc();
+		ui_top_sign_message();
+
+		// derive the signing key on the next idle tick, while the user reviews.
+		prepare_private_key(message_bip44_path());
+		*flags |= IO_ASYNCH_REPLY;
+	}
+}
+
+/** length of the APDU being handled, kept outside of the loop of cpx_main, as dispatch_apdu handles it. */
+static volatile unsigned int rx;
+
+/** length of the response to the APDU being handled. */
+static volatile unsigned int tx;
+
+/** io flags of the response, IO_ASYNCH_REPLY if it is sent once the user approves or denies. */
+static volatile unsigned int flags;
+
 /** refreshes the display if the public key was changed ans we are on the page displaying the public key */
 static void refresh_public_key_display(void) {
 	if ((uiState == UI_PUBLIC_KEY_1)|| (uiState == UI_PUBLIC_KEY_2)) {
@@ -109,11 +441,405 @@ static void refresh_public_key_display(void) {
 	}
 }
 
+/**
+ * handles the APDU of rx bytes in G_io_apdu_buffer. sets tx to the length of the response, and flags to IO_ASYNCH_REPLY if the response
+ * is sent once the user approves or denies. throws the status word. returns false if asked to return to the dashboard.
+ */
+static bool dispatch_apdu(void) {
+	// reading the trace is not recorded, or each read would leave an event behind for the next one.
+	if (G_io_apdu_buffer[1] != INS_GET_TRACE) {
+		TRACE(TRACE_APDU, (G_io_apdu_buffer[1] << 16) | (G_io_apdu_buffer[2] << 8) | G_io_apdu_buffer[3]);
+	}
+
+	// if the buffer doesn't start with the magic byte, return an error.
+	if (G_io_apdu_buffer[0] != CLA) {
+		hashTainted = 1;
+		THROW(0x6E00);
+	}
+
+	// check the second byte (0x01) for the instruction.
+	switch (G_io_apdu_buffer[1]) {
+
+	// we're getting a transaction to sign, in parts.
+	case INS_SIGN: {
+		Timer_Restart();
+
+		// check the fourth byte (0x03) for the paths that follow the transaction.
+		if ((G_io_apdu_buffer[3] != P2_SINGLE_PATH) && (G_io_apdu_buffer[3] != P2_MULTI_PATH)) {
+			hashTainted = 1;
+			THROW(0x6A86);
+		}
+
+		append_raw_tx_chunk();
+
+		// if this is the last part of the transaction, parse the transaction into human readable text, and display it.
+		if (G_io_apdu_buffer[2] == P1_LAST) {
+			scratch_begin(SCRATCH_PARSE);
+
+			// the transaction is followed by the BIP44 path to sign with, or with P2_MULTI_PATH by a list of paths and their count.
+			unsigned int trailer_len = BIP44_BYTE_LENGTH;
+			sign_path_count = 1;
+			if (G_io_apdu_buffer[3] == P2_MULTI_PATH) {
+				sign_path_count = (raw_tx_len > 0) ? raw_tx[raw_tx_len - 1] : 0;
+				if ((sign_path_count == 0) || (sign_path_count > MAX_SIGN_PATHS)) {
+					hashTainted = 1;
+					THROW(0x6D19);
+				}
+				trailer_len = 1 + (sign_path_count * BIP44_BYTE_LENGTH);
+			}
+
+			if (raw_tx_len < trailer_len) {
+				hashTainted = 1;
+				THROW(0x6D18);
+			}
+			raw_tx_body_len = raw_tx_len - trailer_len;
+
+			// hash the transaction, which is everything but the trailing BIP44 paths.
+			cx_hash(&hash.header, CX_LAST, raw_tx, raw_tx_body_len, tx_hash, sizeof(tx_hash));
+
+			// if this exact transaction was already signed with these paths, the host lost the response, so send the signatures again.
+			tx = get_cached_signatures();
+			if (tx != 0) {
+				hashTainted = 1;
+				raw_tx_len = 0;
+				THROW(0x9000);
+			}
+
+			review_type = REVIEW_TX;
+			flags |= IO_ASYNCH_REPLY;
+
+			// a transfer that conforms to the approved spending policy is signed without review.
+			if (policy_allows_tx()) {
+				io_seproxyhal_touch_approve(NULL);
+				break;
+			}
+
+			// parse the transaction into human readable text.
+			display_tx_desc();
+
+			// display the UI, starting at the top screen which is "Sign Tx Now".
+			ui_top_sign();
+
+			// derive the signing key on the next idle tick, while the user reviews.
+			unsigned int bip44_path[BIP44_PATH_LEN];
+			read_bip44_path(raw_tx + raw_tx_body_len, bip44_path);
+			prepare_private_key(bip44_path);
+		}
+
+		flags |= IO_ASYNCH_REPLY;
+
+		// if this is not the last part of the transaction, do not display the UI, and approve the partial transaction.
+		// this adds the TX to the hash.
+		if (G_io_apdu_buffer[2] == P1_MORE) {
+			io_seproxyhal_touch_approve(NULL);
+		}
+	}
+	break;
+
+	// we're getting transactions to sign as a batch, in parts, or asked to review or sign the batch.
+	case INS_SIGN_BATCH: {
+		Timer_Restart();
+
+		tx = sign_batch(&flags);
+		if (flags & IO_ASYNCH_REPLY) {
+			break;
+		}
+
+		// return 0x9000 OK.
+		THROW(0x9000);
+	}
+	break;
+
+	// we're asked to set a spending policy.
+	case INS_SET_SPENDING_POLICY: {
+		Timer_Restart();
+
+		// the screens can't change while a review is displayed.
+		if (is_reviewing_tx()) {
+			THROW(0x6D1E);
+		}
+
+		policy_load_request(G_io_apdu_buffer + APDU_HEADER_LENGTH, get_apdu_buffer_length());
+
+		// display the UI, the reply is sent once the user approves or denies the policy.
+		review_type = REVIEW_POLICY;
+		curr_scr_ix = 0;
+		display_policy_desc();
+		ui_top_sign_policy();
+
+		flags |= IO_ASYNCH_REPLY;
+	}
+	break;
+
+	// we're asked to add a known recipient.
+	case INS_ADD_RECIPIENT: {
+		Timer_Restart();
+
+		// the screens can't change while a review is displayed.
+		if (is_reviewing_tx()) {
+			THROW(0x6D1E);
+		}
+
+		allow_list_load_request(G_io_apdu_buffer + APDU_HEADER_LENGTH, get_apdu_buffer_length());
+
+		// display the UI, the reply is sent once the user approves or denies the recipient.
+		review_type = REVIEW_RECIPIENT;
+		curr_scr_ix = 0;
+		display_recipient_desc();
+		ui_top_add_recipient();
+
+		flags |= IO_ASYNCH_REPLY;
+	}
+	break;
+
+	// we're getting a message to sign, in parts.
+	case INS_SIGN_MESSAGE: {
+		Timer_Restart();
+
+		sign_message(&flags);
+		if (flags & IO_ASYNCH_REPLY) {
+			break;
+		}
+
+		// return 0x9000 OK.
+		THROW(0x9000);
+	}
+	break;
+
+	// we're asked to set the exit timeout.
+	case INS_SET_EXIT_TIMEOUT: {
+		Timer_Restart();
+
+		// the screens can't change while a review is displayed.
+		if (is_reviewing_tx()) {
+			THROW(0x6D1E);
+		}
+
+		// the timeout is already the one asked for, there is nothing to confirm.
+		if (!settings_load_exit_timeout_request(G_io_apdu_buffer + APDU_HEADER_LENGTH, get_apdu_buffer_length())) {
+			THROW(0x9000);
+		}
+
+		// display the UI, the reply is sent once the user approves or denies the timeout.
+		review_type = REVIEW_EXIT_TIMEOUT;
+		curr_scr_ix = 0;
+		display_exit_timeout_desc();
+		ui_top_set_exit_timeout();
+
+		flags |= IO_ASYNCH_REPLY;
+	}
+	break;
+
+	// we're asked for a page of the audit log, the page index is in P1.
+	case INS_GET_AUDIT_LOG: {
+		Timer_Restart();
+
+		tx = audit_log_read_page(G_io_apdu_buffer[2], G_io_apdu_buffer);
+
+		// return 0x9000 OK.
+		THROW(0x9000);
+	}
+	break;
+
+	// we're asked how much of the stack was used.
+	case INS_GET_STACK_USAGE: {
+		Timer_Restart();
+
+		tx = stack_usage_read(G_io_apdu_buffer);
+
+		// return 0x9000 OK.
+		THROW(0x9000);
+	}
+	break;
+
+#ifdef HAVE_TRACE
+	// we're asked for the oldest events of the trace.
+	case INS_GET_TRACE: {
+		Timer_Restart();
+
+		tx = trace_drain(G_io_apdu_buffer);
+
+		// return 0x9000 OK.
+		THROW(0x9000);
+	}
+	break;
+#endif // HAVE_TRACE
+
+#ifdef HAVE_CALL_COUNTS
+	// we're asked for the call counts of the hot paths.
+	case INS_GET_CALL_COUNTS: {
+		Timer_Restart();
+
+		tx = call_counts_read(G_io_apdu_buffer);
+		if (G_io_apdu_buffer[2] == P1_CALL_COUNTS_RESET) {
+			call_counts_reset();
+		}
+
+		// return 0x9000 OK.
+		THROW(0x9000);
+	}
+	break;
+#endif // HAVE_CALL_COUNTS
+
+	// we're asked for the public key.
+	case INS_GET_PUBLIC_KEY: {
+		Timer_Restart();
+
+		cx_ecfp_public_key_t publicKey;
+
+		if (rx < APDU_HEADER_LENGTH + BIP44_BYTE_LENGTH) {
+			hashTainted = 1;
+			THROW(0x6D09);
+		}
+
+		/** BIP44 path, used to derive the private key from the mnemonic by calling os_perso_derive_node_bip32. */
+		unsigned int bip44_path[BIP44_PATH_LEN];
+		read_bip44_path(G_io_apdu_buffer + APDU_HEADER_LENGTH, bip44_path);
+		derive_public_key(bip44_path, &publicKey);
+
+		display_public_key(publicKey.W);
+		refresh_public_key_display();
+
+		// push the public key onto the response buffer.
+		if(G_io_apdu_buffer[1] == INS_GET_PUBLIC_KEY) {
+			// push the public key onto the response buffer.
+			os_memmove(G_io_apdu_buffer, publicKey.W, 65);
+			tx = 65;
+		}
+
+		// return 0x9000 OK.
+		THROW(0x9000);
+	}
+	break;
+
+	// we're asked for the public keys of a range of address indices.
+	case INS_GET_PUBLIC_KEY_BATCH: {
+		Timer_Restart();
+
+		tx = get_public_key_batch();
+
+		// return 0x9000 OK.
+		THROW(0x9000);
+	}
+	break;
+
+	// we're asked for the extended public key of an account.
+	case INS_GET_EXTENDED_PUBLIC_KEY: {
+		Timer_Restart();
+
+		if (rx < APDU_HEADER_LENGTH + ACCOUNT_PATH_BYTE_LENGTH) {
+			hashTainted = 1;
+			THROW(0x6D09);
+		}
+
+		unsigned int account_path[ACCOUNT_PATH_LEN];
+		read_bip32_path(G_io_apdu_buffer + APDU_HEADER_LENGTH, account_path, ACCOUNT_PATH_LEN);
+
+		// only export account level nodes, m/44'/888'/account'
+		if (!is_account_path(account_path)) {
+			THROW(0x6D17);
+		}
+
+		// display the UI, the reply is sent once the user approves or denies the export.
+		ui_export_public_key(account_path);
+
+		flags |= IO_ASYNCH_REPLY;
+	}
+	break;
+
+	case 0xFF: // return to dashboard
+		return false;
+
+		// we're asked to do an unknown command
+	default:
+		// return an error.
+		hashTainted = 1;
+		THROW(0x6D00);
+		break;
+	}
+	return true;
+}
+
+/**
+ * appends the status word of the exception to the response, an exception that is not a status word is sent as 0x68xx.
+ * any error ends the transaction or message being sent in parts, its next part starts it over, so a part is never
+ * hashed after a part that was rejected, or after a request of another kind that failed in between.
+ */
+static void append_status_word(unsigned short e) {
+	unsigned short sw;
+	switch (e & 0xF000) {
+	case 0x6000:
+	case 0x9000:
+		sw = e;
+		break;
+	default:
+		sw = 0x6800 | (e & 0x7FF);
+		break;
+	}
+	if (sw != 0x9000) {
+		hashTainted = 1;
+	}
+	// Unexpected exception => report
+	G_io_apdu_buffer[tx] = sw >> 8;
+	G_io_apdu_buffer[tx + 1] = sw;
+	tx += 2;
+}
+
+/** shows the idle screen with no public key, continues the audit log and starts the exit timer, once the io is up. */
+static void app_start(void) {
+	// init the public key display to "no public key".
+	display_no_public_key();
+
+	// continue the audit log after its newest record.
+	audit_log_init();
+
+	// show idle screen.
+	ui_idle();
+
+	// set timer
+	Timer_Set();
+}
+
+#ifdef HOST_BUILD
+/** starts the app as main does, without the io, for the host build. */
+void host_init(void) {
+	hashTainted = 1;
+	UX_INIT();
+	app_start();
+}
+
+/** handles one APDU as the main loop does, for the host build, which has no io_exchange to wait on. */
+unsigned int host_apdu(unsigned int apdu_len) {
+	rx = apdu_len;
+	tx = 0;
+	flags = 0;
+	BEGIN_TRY
+		{
+			TRY
+				{
+					if (!dispatch_apdu()) {
+						wipe_session();
+					}
+				}
+				CATCH_OTHER(e)
+				{
+					append_status_word(e);
+				}
+				FINALLY
+			{
+				// nothing in the scratch arena outlives the request.
+				scratch_reset();
+			}
+		}
+		END_TRY;
+	return tx;
+}
+#else // HOST_BUILD
 /** main loop. */
 static void cpx_main(void) {
-	volatile unsigned int rx = 0;
-	volatile unsigned int tx = 0;
-	volatile unsigned int flags = 0;
+	rx = 0;
+	tx = 0;
+	flags = 0;
 
 	// DESIGN NOTE: the bootloader ignores the way APDU are fetched. The only
 	// goal is to retrieve APDU.
@@ -122,8 +848,6 @@ static void cpx_main(void) {
 	// switch event, before the apdu is replied to the bootloader. This avoid
 	// APDU injection faults.
 	for (;;) {
-		volatile unsigned short sw = 0;
-
 		BEGIN_TRY
 			{
 				TRY
@@ -140,159 +864,28 @@ static void cpx_main(void) {
 							hashTainted = 1;
 							THROW(0x6982);
 						}
-
-						// if the buffer doesn't start with the magic byte, return an error.
-						if (G_io_apdu_buffer[0] != CLA) {
-							hashTainted = 1;
-							THROW(0x6E00);
-						}
-
-						// check the second byte (0x01) for the instruction.
-						switch (G_io_apdu_buffer[1]) {
-
-						// we're getting a transaction to sign, in parts.
-						case INS_SIGN: {
-							Timer_Restart();
-
-							// check the third byte (0x02) for the instruction subtype.
-							if ((G_io_apdu_buffer[2] != P1_MORE) && (G_io_apdu_buffer[2] != P1_LAST)) {
-								hashTainted = 1;
-								THROW(0x6A86);
-							}
-
-							// if this is the first transaction part, reset the hash and all the other temporary variables.
-							if (hashTainted) {
-								cx_sha256_init(&hash);
-								hashTainted = 0;
-								raw_tx_ix = 0;
-								raw_tx_len = 0;
-							}
-
-							// move the contents of the buffer into raw_tx, and update raw_tx_ix to the end of the buffer, to be ready for the next part of the tx.
-							unsigned int len = get_apdu_buffer_length();
-							unsigned char * in = G_io_apdu_buffer + APDU_HEADER_LENGTH;
-							unsigned char * out = raw_tx + raw_tx_ix;
-							if (raw_tx_ix + len > MAX_TX_RAW_LENGTH) {
-								hashTainted = 1;
-								THROW(0x6D08);
-							}
-							os_memmove(out, in, len);
-							raw_tx_ix += len;
-
-							// set the screen to be the first screen.
-							curr_scr_ix = 0;
-
-							// set the buffer to end with a zero.
-							G_io_apdu_buffer[APDU_HEADER_LENGTH + len] = '\0';
-
-							// if this is the last part of the transaction, parse the transaction into human readable text, and display it.
-							if (G_io_apdu_buffer[2] == P1_LAST) {
-								raw_tx_len = raw_tx_ix;
-								raw_tx_ix = 0;
-
-								// parse the transaction into human readable text.
-								display_tx_desc();
-
-								// display the UI, starting at the top screen which is "Sign Tx Now".
-								ui_top_sign();
-							}
-
-							flags |= IO_ASYNCH_REPLY;
-
-							// if this is not the last part of the transaction, do not display the UI, and approve the partial transaction.
-							// this adds the TX to the hash.
-							if (G_io_apdu_buffer[2] == P1_MORE) {
-								io_seproxyhal_touch_approve(NULL);
-							}
-						}
-						break;
-
-						// we're asked for the public key.
-						case INS_GET_PUBLIC_KEY: {
-							Timer_Restart();
-
-							cx_ecfp_public_key_t publicKey;
-							cx_ecfp_private_key_t privateKey;
-
-							if (rx < APDU_HEADER_LENGTH + BIP44_BYTE_LENGTH) {
-								hashTainted = 1;
-								THROW(0x6D09);
-							}
-
-							/** BIP44 path, used to derive the private key from the mnemonic by calling os_perso_derive_node_bip32. */
-							unsigned char * bip44_in = G_io_apdu_buffer + APDU_HEADER_LENGTH;
-
-							unsigned int bip44_path[BIP44_PATH_LEN];
-							uint32_t i;
-							for (i = 0; i < BIP44_PATH_LEN; i++) {
-								bip44_path[i] = (bip44_in[0] << 24) | (bip44_in[1] << 16) | (bip44_in[2] << 8) | (bip44_in[3]);
-								bip44_in += 4;
-							}
-
-							unsigned char privateKeyData[32];
-							os_perso_derive_node_bip32(CX_CURVE_256R1, bip44_path, BIP44_PATH_LEN, privateKeyData, NULL);
-							cx_ecdsa_init_private_key(CX_CURVE_256R1, privateKeyData, 32, &privateKey);
-
-							// generate the public key.
-							cx_ecdsa_init_public_key(CX_CURVE_256R1, NULL, 0, &publicKey);
-							cx_ecfp_generate_pair(CX_CURVE_256R1, &publicKey, &privateKey, 1);
-
-							// clear private key data
-							cx_ecdsa_init_private_key(CX_CURVE_256R1, NULL, 0, &privateKey);
-							// memset(&privateKey, 0x00, sizeof(privateKey));
-							memset(privateKeyData, 0x00, sizeof(privateKeyData));
-
-							display_public_key(publicKey.W);
-							refresh_public_key_display();
-
-							// push the public key onto the response buffer.
-							if(G_io_apdu_buffer[1] == INS_GET_PUBLIC_KEY) {
-								// push the public key onto the response buffer.
-								os_memmove(G_io_apdu_buffer, publicKey.W, 65);
-								tx = 65;
-							}
-
-							// return 0x9000 OK.
-							THROW(0x9000);
-						}
-						break;
-
-						case 0xFF: // return to dashboard
+						if (!dispatch_apdu()) {
 							goto return_to_dashboard;
-
-							// we're asked to do an unknown command
-						default:
-							// return an error.
-							hashTainted = 1;
-							THROW(0x6D00);
-							break;
 						}
 					}
 					CATCH_OTHER(e)
 					{
-						switch (e & 0xF000) {
-						case 0x6000:
-						case 0x9000:
-							sw = e;
-							break;
-						default:
-							sw = 0x6800 | (e & 0x7FF);
-							break;
-						}
-						// Unexpected exception => report
-						G_io_apdu_buffer[tx] = sw >> 8;
-						G_io_apdu_buffer[tx + 1] = sw;
-						tx += 2;
+						append_status_word(e);
 					}
 					FINALLY
 				{
+					// nothing in the scratch arena outlives the request.
+					scratch_reset();
 				}
 			}
 			END_TRY;
 	}
 
-	return_to_dashboard: return;
+	return_to_dashboard:
+	wipe_session();
+	return;
 }
+#endif // HOST_BUILD
 
 /** display function */
 void io_seproxyhal_display(const bagl_element_t *element) {
@@ -320,12 +913,21 @@ unsigned char io_event(unsigned char channel) {
 		//Timer_Restart();
 		if (UX_DISPLAYED()) {
 			// perform actions after all screen elements have been displayed
+			ui_redisplay_done();
 		} else {
 			UX_DISPLAYED_EVENT();
 		}
 		break;
 
 	case SEPROXYHAL_TAG_TICKER_EVENT:
+		// the device is idle while the user reviews, so derive the signing key now, approving then only has to sign.
+		if (is_reviewing_tx()) {
+			derive_prepared_private_key();
+		}
+		policy_tick();
+		// the records of the signatures sent are written here, once they fill a page, never while a request waits.
+		audit_log_tick();
+		TRACE_TICK();
 #if defined(TARGET_NANOX)
 	UX_TICKER_EVENT(G_io_seproxyhal_spi_buffer, {
             // don't redisplay if UX not allowed (pin locked in the common bolos
@@ -337,18 +939,18 @@ unsigned char io_event(unsigned char channel) {
         });
 #else
 //		UX_REDISPLAY();
-		Timer_Tick();
+		// only the address lines changed, the rest of the screen is not sent again.
 		if (publicKeyNeedsRefresh == 1) {
-			UX_REDISPLAY();
+			ui_refresh_public_key();
 			publicKeyNeedsRefresh = 0;
-		} else {
-			if (Timer_Expired()) {
-				os_sched_exit(0);
-			} else {
-				Timer_UpdateDisplay();
-			}
 		}
 #endif
+		// the exit timer runs on every device, the timeout applies to Nano X as well.
+		Timer_Tick();
+		if (Timer_Expired()) {
+			wipe_session();
+			os_sched_exit(0);
+		}
 		break;
 
 		// unknown events are acknowledged
@@ -366,11 +968,15 @@ unsigned char io_event(unsigned char channel) {
 	return 1;
 }
 
+#ifndef HOST_BUILD
 /** boot up the app and intialize it */
 __attribute__((section(".boot"))) int main(void) {
 	// exit critical section
 	__asm volatile("cpsie i");
 
+	// paint the free stack, so the deepest it is used can be read back with INS_GET_STACK_USAGE.
+	stack_usage_paint();
+
 	curr_scr_ix = 0;
 	max_scr_ix = 0;
 	raw_tx_ix = 0;
@@ -400,14 +1006,7 @@ __attribute__((section(".boot"))) int main(void) {
 					USB_power(0);
 					USB_power(1);
 
-					// init the public key display to "no public key".
-					display_no_public_key();
-
-					// show idle screen.
-					ui_idle();
-
-					// set timer
-					Timer_Set();
+					app_start();
 
 					// run main event loop.
 					cpx_main();
@@ -421,3 +1020,4 @@ __attribute__((section(".boot"))) int main(void) {
 		}
 		END_TRY;
 }
+#endif // HOST_BUILD
@@ -0,0 +1,73 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "message.h"
+#include "keys.h"
+
+/**
+ * prefix of the hash signed for a message.
+ * the fifth byte of a transaction is its type, and 'S' is not one, so the signed hash can never be the hash of a transaction the app signs.
+ */
+static const char MESSAGE_MAGIC[] = "CPX Signed Message:\n";
+
+/** the message being signed, only its start is kept, the rest is hashed as it arrives. */
+static struct {
+	unsigned int bip44_path[BIP44_PATH_LEN];
+	unsigned int length;
+	unsigned char preview[MESSAGE_PREVIEW_LEN];
+	unsigned char hash[SHA256_HASH_LEN];
+} message;
+
+void message_start(const unsigned char * in, unsigned int in_len) {
+	message_wipe();
+	if (in_len < BIP44_BYTE_LENGTH) {
+		hashTainted = 1;
+		THROW(0x6D21);
+	}
+	read_bip44_path(in, message.bip44_path);
+	cx_sha256_init(&hash);
+	message_append(in + BIP44_BYTE_LENGTH, in_len - BIP44_BYTE_LENGTH);
+}
+
+void message_append(const unsigned char * in, unsigned int in_len) {
+	if (message.length < MESSAGE_PREVIEW_LEN) {
+		unsigned int preview_len = MESSAGE_PREVIEW_LEN - message.length;
+		if (preview_len > in_len) {
+			preview_len = in_len;
+		}
+		os_memmove(message.preview + message.length, in, preview_len);
+	}
+	message.length += in_len;
+	cx_hash(&hash.header, 0, in, in_len, NULL, 0);
+}
+
+void message_finish(void) {
+	cx_hash(&hash.header, CX_LAST, NULL, 0, message.hash, sizeof(message.hash));
+
+	// sign the hash of the magic and the message hash, never the message hash itself.
+	cx_sha256_init(&hash);
+	cx_hash(&hash.header, 0, (const unsigned char *) MESSAGE_MAGIC, sizeof(MESSAGE_MAGIC) - 1, NULL, 0);
+	cx_hash(&hash.header, CX_LAST, message.hash, sizeof(message.hash), tx_hash, sizeof(tx_hash));
+	hashTainted = 1;
+}
+
+const unsigned int * message_bip44_path(void) {
+	return message.bip44_path;
+}
+
+unsigned int message_length(void) {
+	return message.length;
+}
+
+const unsigned char * message_preview(unsigned int * preview_len) {
+	*preview_len = (message.length < MESSAGE_PREVIEW_LEN) ? message.length : MESSAGE_PREVIEW_LEN;
+	return message.preview;
+}
+
+const unsigned char * message_hash(void) {
+	return message.hash;
+}
+
+void message_wipe(void) {
+	os_memset(&message, 0x00, sizeof(message));
+}
@@ -0,0 +1,43 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef MESSAGE_H
+#define MESSAGE_H
+
+#include "os.h"
+#include "cx.h"
+#include <stdbool.h>
+#include "ui.h"
+#include "sha256_hash_len.h"
+
+/** number of bytes of the start of the message kept to be displayed. */
+#define MESSAGE_PREVIEW_LEN 32
+
+/** starts a message to sign, in streams, with the first part, which starts with the BIP44 path to sign with. */
+void message_start(const unsigned char * in, unsigned int in_len);
+
+/** hashes the next part of the message. */
+void message_append(const unsigned char * in, unsigned int in_len);
+
+/**
+ * once all parts are hashed, computes the hash to sign into tx_hash,
+ * the SHA-256 of MESSAGE_MAGIC followed by the SHA-256 of the message.
+ */
+void message_finish(void);
+
+/** returns the BIP44 path to sign the message with. */
+const unsigned int * message_bip44_path(void);
+
+/** returns the length of the message. */
+unsigned int message_length(void);
+
+/** returns the start of the message, and sets preview_len to its length. */
+const unsigned char * message_preview(unsigned int * preview_len);
+
+/** returns the SHA-256 of the message. */
+const unsigned char * message_hash(void);
+
+/** forgets the message. */
+void message_wipe(void);
+
+#endif // MESSAGE_H
@@ -0,0 +1,61 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "paginator.h"
+
+void paginator_init(field_text_t * field, const char * label, unsigned int line_width) {
+	os_memset(field, 0x00, sizeof(field_text_t));
+	snprintf(field->label, sizeof(field->label), "%s", label);
+	field->line_width = line_width;
+}
+
+unsigned int paginator_line_count(const field_text_t * field) {
+	if (field->value_len == 0) {
+		return 1;
+	}
+	return (field->value_len + field->line_width - 1) / field->line_width;
+}
+
+void paginator_line(const field_text_t * field, unsigned int line_ix, char * line) {
+	os_memset(line, '\0', MAX_TX_TEXT_WIDTH);
+	const unsigned int start = line_ix * field->line_width;
+	if (start >= field->value_len) {
+		return;
+	}
+	unsigned int len = field->value_len - start;
+	if (len > field->line_width) {
+		len = field->line_width;
+	}
+	os_memmove(line, field->value + start, len);
+}
+
+unsigned int paginator_page_count(const field_text_t * field, unsigned int page_lines) {
+	// the label line, then the lines of the value.
+	const unsigned int line_count = 1 + paginator_line_count(field);
+	if (line_count <= page_lines) {
+		return 1;
+	}
+	return line_count - page_lines + 1;
+}
+
+void paginator_page(const field_text_t * field, unsigned int page_ix, unsigned int page_lines, char lines[][MAX_TX_TEXT_WIDTH]) {
+	for (unsigned int ix = 0; ix < page_lines; ix++) {
+		const unsigned int line_ix = page_ix + ix;
+		if (line_ix == 0) {
+			os_memmove(lines[ix], field->label, MAX_TX_TEXT_WIDTH);
+		} else {
+			paginator_line(field, line_ix - 1, lines[ix]);
+		}
+	}
+}
+
+unsigned int paginator_step_count(const field_text_t * field, unsigned int step_lines) {
+	return (paginator_line_count(field) + step_lines - 1) / step_lines;
+}
+
+void paginator_step(const field_text_t * field, unsigned int step_ix, unsigned int step_lines, char lines[][MAX_TX_TEXT_WIDTH]) {
+	os_memmove(lines[0], field->label, MAX_TX_TEXT_WIDTH);
+	for (unsigned int ix = 0; ix < step_lines; ix++) {
+		paginator_line(field, (step_ix * step_lines) + ix, lines[1 + ix]);
+	}
+}
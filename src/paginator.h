@@ -0,0 +1,56 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef PAGINATOR_H
+#define PAGINATOR_H
+
+#include "os.h"
+#include <stdbool.h>
+#include "ui.h"
+
+/**
+ * max length of the value of a field, as text, enough for a 32 byte hash in hex, and for the largest 32 byte amount:
+ * 78 digits, the decimal point and the terminating zero written by adjustDecimals.
+ */
+#define MAX_FIELD_VALUE_LEN 80
+
+/**
+ * a field to display, its label and its value rendered once as a single string.
+ * the value is split into lines of line_width characters when a page is displayed, so a field of any length needs no layout code of its own.
+ */
+typedef struct {
+	/** label of the field, shown on the first line. */
+	char label[MAX_TX_TEXT_WIDTH];
+	/** value of the field, not null terminated. */
+	char value[MAX_FIELD_VALUE_LEN];
+	/** length of the value. */
+	unsigned int value_len;
+	/** number of characters of the value that fit on a line, depends on the characters used. */
+	unsigned int line_width;
+} field_text_t;
+
+/** clears the field, and sets its label and the line width of its value. */
+void paginator_init(field_text_t * field, const char * label, unsigned int line_width);
+
+/** returns the number of lines of the value, at least one. */
+unsigned int paginator_line_count(const field_text_t * field);
+
+/** copies the line at line_ix of the value into line, null terminated, or an empty line past the end of the value. */
+void paginator_line(const field_text_t * field, unsigned int line_ix, char * line);
+
+/**
+ * returns the number of pages of page_lines lines.
+ * the lines are the label followed by the lines of the value, and each page starts one line further than the previous one.
+ */
+unsigned int paginator_page_count(const field_text_t * field, unsigned int page_lines);
+
+/** copies the page_lines lines of the page at page_ix into lines. */
+void paginator_page(const field_text_t * field, unsigned int page_ix, unsigned int page_lines, char lines[][MAX_TX_TEXT_WIDTH]);
+
+/** returns the number of steps that each show the label as their title, followed by up to step_lines lines of the value. */
+unsigned int paginator_step_count(const field_text_t * field, unsigned int step_lines);
+
+/** copies the label into lines[0], and the step_lines lines of the value of the step at step_ix into the following lines. */
+void paginator_step(const field_text_t * field, unsigned int step_ix, unsigned int step_lines, char lines[][MAX_TX_TEXT_WIDTH]);
+
+#endif // PAGINATOR_H
@@ -0,0 +1,148 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "policy.h"
+#include "keys.h"
+
+/** the spending policy, under which transfers are signed without review. */
+static struct {
+	bool active;
+	unsigned int account_path[ACCOUNT_PATH_LEN];
+	uint256_t max_value;
+	uint256_t budget;
+	uint256_t spent;
+	unsigned char minutes;
+	unsigned int ticks_left;
+	unsigned char recipient_count;
+	unsigned char recipients[MAX_POLICY_RECIPIENTS][SCRIPT_HASH_LEN];
+} policy;
+
+/** reads a length byte and a big endian number of up to 32 bytes at *ix, throws an error if the request is too short. */
+static void read_policy_amount(const unsigned char * in, unsigned int in_len, unsigned int * ix, uint256_t * amount) {
+	if (*ix >= in_len) {
+		THROW(0x6D20);
+	}
+	unsigned int amount_len = in[(*ix)++];
+	if ((amount_len > 32) || (*ix + amount_len > in_len)) {
+		THROW(0x6D20);
+	}
+	convertUint256BE((uint8_t *) in + *ix, amount_len, amount);
+	*ix += amount_len;
+}
+
+void policy_load_request(const unsigned char * in, unsigned int in_len) {
+	unsigned int ix = 0;
+
+	policy_wipe();
+
+	if (in_len < ACCOUNT_PATH_BYTE_LENGTH) {
+		THROW(0x6D20);
+	}
+	read_bip32_path(in, policy.account_path, ACCOUNT_PATH_LEN);
+	if (!is_account_path(policy.account_path)) {
+		THROW(0x6D17);
+	}
+	ix += ACCOUNT_PATH_BYTE_LENGTH;
+
+	read_policy_amount(in, in_len, &ix, &policy.max_value);
+	read_policy_amount(in, in_len, &ix, &policy.budget);
+
+	if (ix + 2 > in_len) {
+		THROW(0x6D20);
+	}
+	policy.minutes = in[ix++];
+	policy.recipient_count = in[ix++];
+	if ((policy.recipient_count == 0) || (policy.recipient_count > MAX_POLICY_RECIPIENTS)
+			|| (ix + (policy.recipient_count * SCRIPT_HASH_LEN) != in_len)) {
+		THROW(0x6D20);
+	}
+	os_memmove(policy.recipients, in + ix, policy.recipient_count * SCRIPT_HASH_LEN);
+}
+
+void policy_activate(void) {
+	clear256(&policy.spent);
+	policy.ticks_left = policy.minutes * POLICY_TICKS_PER_MINUTE;
+	policy.active = true;
+}
+
+void policy_wipe(void) {
+	os_memset(&policy, 0x00, sizeof(policy));
+}
+
+void policy_tick(void) {
+	if (!policy.active || (policy.minutes == 0)) {
+		return;
+	}
+	if (policy.ticks_left > 0) {
+		policy.ticks_left--;
+	}
+	if (policy.ticks_left == 0) {
+		policy_wipe();
+	}
+}
+
+/** returns true if the script hash is one of the allowed recipients. */
+static bool is_allowed_recipient(const unsigned char * script_hash) {
+	for (unsigned int ix = 0; ix < policy.recipient_count; ix++) {
+		if (os_memcmp(policy.recipients[ix], script_hash, SCRIPT_HASH_LEN) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool policy_allows_tx(void) {
+	if (!policy.active || (sign_path_count != 1)) {
+		return false;
+	}
+
+	unsigned int bip44_path[BIP44_PATH_LEN];
+	read_bip44_path(raw_tx + raw_tx_body_len, bip44_path);
+	if (os_memcmp(bip44_path, policy.account_path, ACCOUNT_PATH_BYTE_LENGTH) != 0) {
+		return false;
+	}
+
+	// parse from the start, and leave raw_tx ready to be parsed again for review.
+	tx_summary_t summary;
+	raw_tx_ix = 0;
+	bool is_transfer = parse_tx_summary(&summary);
+	raw_tx_ix = 0;
+	if (!is_transfer || !is_allowed_recipient(summary.to) || gt256(&summary.value, &policy.max_value)) {
+		return false;
+	}
+
+	// the fee counts against the budget too.
+	uint256_t cost;
+	uint256_t spent;
+	add256(&summary.value, &summary.fee, &cost);
+	add256(&policy.spent, &cost, &spent);
+	if (gt256(&summary.value, &cost) || gt256(&cost, &spent) || gt256(&spent, &policy.budget)) {
+		return false;
+	}
+	copy256(&policy.spent, &spent);
+	return true;
+}
+
+const unsigned int * policy_account_path(void) {
+	return policy.account_path;
+}
+
+const uint256_t * policy_max_value(void) {
+	return &policy.max_value;
+}
+
+const uint256_t * policy_budget(void) {
+	return &policy.budget;
+}
+
+unsigned char policy_minutes(void) {
+	return policy.minutes;
+}
+
+unsigned char policy_recipient_count(void) {
+	return policy.recipient_count;
+}
+
+const unsigned char * policy_recipient(unsigned int ix) {
+	return policy.recipients[ix];
+}
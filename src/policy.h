@@ -0,0 +1,61 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "os.h"
+#include "cx.h"
+#include <stdbool.h>
+#include "ui.h"
+#include "cpx.h"
+#include "uint256.h"
+
+/** max number of recipients a spending policy allows. */
+#define MAX_POLICY_RECIPIENTS 4
+
+/** number of ticker events in a minute, the ticker runs every 100 ms. */
+#define POLICY_TICKS_PER_MINUTE 600
+
+/**
+ * reads a spending policy request, to be reviewed, and forgets the current policy.
+ * the request is the account path, the max value of a transfer and the budget (each a length byte and a big endian number),
+ * the minutes the policy is valid for (0 for the session), the number of recipients and their script hashes.
+ */
+void policy_load_request(const unsigned char * in, unsigned int in_len);
+
+/** starts the reviewed spending policy. */
+void policy_activate(void);
+
+/** forgets the spending policy. */
+void policy_wipe(void);
+
+/** counts down the time left of the spending policy, called on each ticker event. */
+void policy_tick(void);
+
+/**
+ * returns true if the transaction in raw_tx can be signed without review, and then counts its value against the budget.
+ * it must be a transfer to an allowed recipient, signed with one path of the policy's account, within the max value,
+ * and its value and fee must fit in what is left of the budget.
+ */
+bool policy_allows_tx(void);
+
+/** returns the account path of the policy. */
+const unsigned int * policy_account_path(void);
+
+/** returns the max value of a transfer. */
+const uint256_t * policy_max_value(void);
+
+/** returns the total value the policy allows. */
+const uint256_t * policy_budget(void);
+
+/** returns the minutes the policy is valid for, 0 for the session. */
+unsigned char policy_minutes(void);
+
+/** returns the number of allowed recipients. */
+unsigned char policy_recipient_count(void);
+
+/** returns the script hash of the allowed recipient at ix. */
+const unsigned char * policy_recipient(unsigned int ix);
+
+#endif // POLICY_H
@@ -0,0 +1,45 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "scratch.h"
+
+/** the arena, as words so every allocation is word aligned. */
+static unsigned int scratch_arena[(SCRATCH_ARENA_SIZE + sizeof(unsigned int) - 1) / sizeof(unsigned int)];
+
+/** number of bytes of the arena allocated. */
+static unsigned int scratch_top;
+
+/** the current phase. */
+static enum SCRATCH_PHASE scratch_phase;
+
+void scratch_begin(enum SCRATCH_PHASE phase) {
+	scratch_top = 0;
+	scratch_phase = phase;
+}
+
+void * scratch_alloc(unsigned int size) {
+	// round up to a word, so the next allocation stays aligned.
+	size = (size + sizeof(unsigned int) - 1) & ~(sizeof(unsigned int) - 1);
+	if ((scratch_phase == SCRATCH_IDLE) || (size > sizeof(scratch_arena) - scratch_top)) {
+		hashTainted = 1;
+		THROW(0x6D23);
+	}
+	void * allocated = ((unsigned char *) scratch_arena) + scratch_top;
+	scratch_top += size;
+	return allocated;
+}
+
+unsigned int scratch_mark(void) {
+	return scratch_top;
+}
+
+void scratch_release(unsigned int mark) {
+	if (mark < scratch_top) {
+		scratch_top = mark;
+	}
+}
+
+void scratch_reset(void) {
+	os_memset(scratch_arena, 0x00, sizeof(scratch_arena));
+	scratch_begin(SCRATCH_IDLE);
+}
@@ -0,0 +1,38 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include "os.h"
+#include "cx.h"
+#include "ui.h"
+#include "sha256_hash_len.h"
+
+/**
+ * size of the scratch arena, in bytes.
+ * the largest user is to_address, a SHA-256 context and its two results, the base58 buffers are allocated once it released them.
+ */
+#define SCRATCH_ARENA_SIZE (sizeof(cx_sha256_t) + (2 * SHA256_HASH_LEN))
+
+/** what the request is doing, starting a phase releases everything allocated in the previous one. nothing can be allocated while SCRATCH_IDLE. */
+enum SCRATCH_PHASE {
+	SCRATCH_IDLE, SCRATCH_UPLOAD, SCRATCH_PARSE, SCRATCH_RENDER, SCRATCH_SIGN
+};
+
+/** starts a phase of the request, releasing everything allocated so far. */
+void scratch_begin(enum SCRATCH_PHASE phase);
+
+/** allocates size bytes from the arena, throws an error if they don't fit, or if no phase was started. */
+void * scratch_alloc(unsigned int size);
+
+/** returns the current end of the allocations, to release everything allocated after it with scratch_release. */
+unsigned int scratch_mark(void);
+
+/** releases everything allocated since mark was taken. */
+void scratch_release(unsigned int mark);
+
+/** wipes the arena and goes back to SCRATCH_IDLE, called once a request is done. */
+void scratch_reset(void);
+
+#endif // SCRATCH_H
@@ -0,0 +1,65 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "settings.h"
+
+/** settings kept in NVRAM, across app restarts. */
+typedef struct {
+	/** true once the settings were written, the NVRAM of a new install is all zeros. */
+	unsigned char initialized;
+	/** time without activity after which the app exits, in seconds. */
+	unsigned short exit_timeout;
+} settings_t;
+
+/** the settings, in NVRAM. */
+const settings_t N_settings_real;
+
+/** the settings, at their address in the loaded app. */
+#define N_settings (*(volatile settings_t *) PIC(&N_settings_real))
+
+/** exit timeout being reviewed, in seconds, 0 if there is none. */
+static unsigned int requested_exit_timeout;
+
+unsigned int settings_exit_timeout(void) {
+	if (!N_settings.initialized) {
+		return DEFAULT_EXIT_TIMEOUT;
+	}
+	return N_settings.exit_timeout;
+}
+
+bool settings_load_exit_timeout_request(const unsigned char * in, unsigned int in_len) {
+	settings_wipe_request();
+	if (in_len != EXIT_TIMEOUT_REQUEST_LEN) {
+		THROW(0x6D22);
+	}
+	const unsigned int exit_timeout = (in[0] << 8) | in[1];
+	if ((exit_timeout < MIN_EXIT_TIMEOUT) || (exit_timeout > MAX_EXIT_TIMEOUT)) {
+		THROW(0x6D22);
+	}
+
+	// NVRAM pages wear out, and the user is not asked for nothing, so only go on when the timeout changes.
+	if (exit_timeout == settings_exit_timeout()) {
+		return false;
+	}
+	requested_exit_timeout = exit_timeout;
+	return true;
+}
+
+unsigned int settings_requested_exit_timeout(void) {
+	return requested_exit_timeout;
+}
+
+void settings_approve_exit_timeout(void) {
+	if (requested_exit_timeout == 0) {
+		return;
+	}
+	settings_t settings;
+	settings.initialized = 1;
+	settings.exit_timeout = requested_exit_timeout;
+	nvm_write((void *) &N_settings, &settings, sizeof(settings));
+	settings_wipe_request();
+}
+
+void settings_wipe_request(void) {
+	requested_exit_timeout = 0;
+}
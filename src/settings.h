@@ -0,0 +1,40 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include "os.h"
+#include <stdbool.h>
+
+/** exit timeout until one is set, in seconds, the timeout of earlier versions. */
+#define DEFAULT_EXIT_TIMEOUT 410
+
+/** shortest exit timeout that can be set, in seconds. */
+#define MIN_EXIT_TIMEOUT 30
+
+/** longest exit timeout that can be set, in seconds. */
+#define MAX_EXIT_TIMEOUT 3600
+
+/** length of a set exit timeout request, the timeout in seconds as a big endian short. */
+#define EXIT_TIMEOUT_REQUEST_LEN 2
+
+/** returns the time without activity after which the app exits, in seconds. */
+unsigned int settings_exit_timeout(void);
+
+/**
+ * reads the exit timeout from the request, to be reviewed, throws an error if it is out of range.
+ * returns false if it is the current timeout, there is nothing to review then.
+ */
+bool settings_load_exit_timeout_request(const unsigned char * in, unsigned int in_len);
+
+/** returns the exit timeout being reviewed, in seconds. */
+unsigned int settings_requested_exit_timeout(void);
+
+/** writes the reviewed exit timeout to NVRAM. */
+void settings_approve_exit_timeout(void);
+
+/** forgets the request. */
+void settings_wipe_request(void);
+
+#endif // SETTINGS_H
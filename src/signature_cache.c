@@ -0,0 +1,47 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "signature_cache.h"
+
+/** a signature, and what was signed. */
+typedef struct signature_cache_entry_t {
+	unsigned char tx_hash[SHA256_HASH_LEN];
+	unsigned int bip44_path[BIP44_PATH_LEN];
+	unsigned char signature_len;
+	unsigned char signature[MAX_SIGNATURE_LEN];
+} signature_cache_entry_t;
+
+/** the most recent signatures of this session. */
+static signature_cache_entry_t signature_cache[SIGNATURE_CACHE_SIZE];
+
+/** index of the entry to replace next. */
+static unsigned char signature_cache_next_ix;
+
+void signature_cache_put(const unsigned char * tx_hash, const unsigned int * bip44_path, const unsigned char * signature, unsigned int signature_len) {
+	if (signature_len > MAX_SIGNATURE_LEN) {
+		return;
+	}
+	signature_cache_entry_t * entry = &signature_cache[signature_cache_next_ix];
+	os_memmove(entry->tx_hash, tx_hash, SHA256_HASH_LEN);
+	os_memmove(entry->bip44_path, bip44_path, BIP44_BYTE_LENGTH);
+	os_memmove(entry->signature, signature, signature_len);
+	entry->signature_len = signature_len;
+	signature_cache_next_ix = (signature_cache_next_ix + 1) % SIGNATURE_CACHE_SIZE;
+}
+
+unsigned int signature_cache_get(const unsigned char * tx_hash, const unsigned int * bip44_path, unsigned char * signature) {
+	for (unsigned int ix = 0; ix < SIGNATURE_CACHE_SIZE; ix++) {
+		const signature_cache_entry_t * entry = &signature_cache[ix];
+		if ((entry->signature_len != 0) && (os_memcmp(entry->tx_hash, tx_hash, SHA256_HASH_LEN) == 0)
+				&& (os_memcmp(entry->bip44_path, bip44_path, BIP44_BYTE_LENGTH) == 0)) {
+			os_memmove(signature, entry->signature, entry->signature_len);
+			return entry->signature_len;
+		}
+	}
+	return 0;
+}
+
+void signature_cache_wipe(void) {
+	os_memset(signature_cache, 0x00, sizeof(signature_cache));
+	signature_cache_next_ix = 0;
+}
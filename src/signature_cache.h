@@ -0,0 +1,30 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef SIGNATURE_CACHE_H
+#define SIGNATURE_CACHE_H
+
+#include "os.h"
+#include "cx.h"
+#include "ui.h"
+#include "sha256_hash_len.h"
+
+/**
+ * number of signatures kept, the oldest one is replaced first.
+ * a retry is only answered from the cache if the signatures of all of its paths are there, so there is room for all of them.
+ */
+#define SIGNATURE_CACHE_SIZE MAX_SIGN_PATHS
+
+/** max length of a DER encoded ECDSA signature. */
+#define MAX_SIGNATURE_LEN 72
+
+/** remembers the signature of the transaction hash, signed with the given BIP44 path. */
+void signature_cache_put(const unsigned char * tx_hash, const unsigned int * bip44_path, const unsigned char * signature, unsigned int signature_len);
+
+/** copies the signature of the transaction hash and BIP44 path into signature, returns its length, or 0 if it was not signed in this session. */
+unsigned int signature_cache_get(const unsigned char * tx_hash, const unsigned int * bip44_path, unsigned char * signature);
+
+/** forgets all signatures. */
+void signature_cache_wipe(void);
+
+#endif // SIGNATURE_CACHE_H
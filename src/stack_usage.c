@@ -0,0 +1,51 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "stack_usage.h"
+
+#include <stdint.h>
+
+/** bottom of the stack, from the linker script of the SDK, the stack grows down towards it. */
+extern unsigned int _stack;
+
+/** top of the stack, from the linker script of the SDK. */
+extern unsigned int _estack;
+
+/** returns the address of a word in the frame of the caller, just under its stack pointer. */
+static __attribute__((noinline)) uintptr_t current_sp(void) {
+	volatile unsigned int here = 0;
+	return (uintptr_t) &here;
+}
+
+void stack_usage_paint(void) {
+	// volatile, so the compiler doesn't turn the loop into a call to memset, with a frame of its own.
+	volatile unsigned int * word = &_stack;
+	const uintptr_t end = current_sp() - STACK_PAINT_MARGIN;
+	while ((uintptr_t) word < end) {
+		*word++ = STACK_PAINT;
+	}
+}
+
+/** writes value to out, 4 bytes big endian. */
+static void write_u32_be(unsigned char * out, unsigned int value) {
+	out[0] = (value >> 24) & 0xFF;
+	out[1] = (value >> 16) & 0xFF;
+	out[2] = (value >> 8) & 0xFF;
+	out[3] = value & 0xFF;
+}
+
+unsigned int stack_usage_read(unsigned char * out) {
+	const uintptr_t bottom = (uintptr_t) &_stack;
+	const uintptr_t top = (uintptr_t) &_estack;
+
+	// the first word from the bottom that isn't the paint anymore is the deepest the stack went.
+	const volatile unsigned int * word = &_stack;
+	while (((uintptr_t) word < top) && (*word == STACK_PAINT)) {
+		word++;
+	}
+
+	write_u32_be(out, top - bottom);
+	write_u32_be(out + 4, top - (uintptr_t) word);
+	write_u32_be(out + 8, current_sp() - bottom);
+	return 12;
+}
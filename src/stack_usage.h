@@ -0,0 +1,24 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef STACK_USAGE_H
+#define STACK_USAGE_H
+
+#include "os.h"
+
+/** word the free part of the stack is painted with at startup, a word that is no longer this one was touched. */
+#define STACK_PAINT 0xA5C35A3C
+
+/** bytes left unpainted below the frame that paints, for the calls it makes itself. */
+#define STACK_PAINT_MARGIN 64
+
+/** paints the stack, from its bottom up to the frame of the caller, called once at startup in main. */
+void stack_usage_paint(void);
+
+/**
+ * writes the size of the stack, the deepest it was ever used since startup and the free room below the current frame,
+ * each 4 bytes big endian, to out, and returns the length written.
+ */
+unsigned int stack_usage_read(unsigned char * out);
+
+#endif // STACK_USAGE_H
@@ -0,0 +1,71 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#include "trace.h"
+
+#ifdef HAVE_TRACE
+
+/** an event, kept as it was recorded, it is only laid out when drained. */
+typedef struct {
+	unsigned int tick;
+	unsigned int event_payload;
+} trace_event_t;
+
+/** the events not drained yet, in RAM, as a ring. */
+static struct {
+	trace_event_t events[TRACE_SIZE];
+	/** number of events ever recorded, the next one goes at written % TRACE_SIZE. */
+	unsigned int written;
+	/** number of events ever drained or replaced. */
+	unsigned int read;
+	/** number of events replaced before they were drained, since the last drain. */
+	unsigned int dropped;
+	/** ticker events since startup. */
+	unsigned int ticks;
+} trace;
+
+void trace_add(enum TRACE_EVENT event, unsigned int payload) {
+	trace_event_t * entry = &trace.events[trace.written % TRACE_SIZE];
+	entry->tick = trace.ticks;
+	entry->event_payload = (event << 24) | (payload & 0xFFFFFF);
+	trace.written++;
+	if (trace.written - trace.read > TRACE_SIZE) {
+		trace.read++;
+		trace.dropped++;
+	}
+}
+
+void trace_tick(void) {
+	trace.ticks++;
+}
+
+/** writes value to out, 4 bytes big endian. */
+static void write_u32_be(unsigned char * out, unsigned int value) {
+	out[0] = (value >> 24) & 0xFF;
+	out[1] = (value >> 16) & 0xFF;
+	out[2] = (value >> 8) & 0xFF;
+	out[3] = value & 0xFF;
+}
+
+unsigned int trace_drain(unsigned char * out) {
+	unsigned int count = trace.written - trace.read;
+	if (count > TRACE_DRAIN_EVENTS) {
+		count = TRACE_DRAIN_EVENTS;
+	}
+	const unsigned int dropped = (trace.dropped > 0xFFFF) ? 0xFFFF : trace.dropped;
+	unsigned int len = 0;
+	out[len++] = (dropped >> 8) & 0xFF;
+	out[len++] = dropped & 0xFF;
+	out[len++] = count;
+	for (unsigned int ix = 0; ix < count; ix++) {
+		const trace_event_t * entry = &trace.events[trace.read % TRACE_SIZE];
+		write_u32_be(out + len, entry->tick);
+		write_u32_be(out + len + 4, entry->event_payload);
+		len += TRACE_EVENT_LEN;
+		trace.read++;
+	}
+	trace.dropped = 0;
+	return len;
+}
+
+#endif // HAVE_TRACE
@@ -0,0 +1,62 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "os.h"
+
+/** the events recorded in the trace. */
+enum TRACE_EVENT {
+	/** an APDU arrived, the payload is its INS, P1 and P2. */
+	TRACE_APDU = 1,
+	/** a part of a transaction was appended to raw_tx, the payload is the length of raw_tx. */
+	TRACE_CHUNK,
+	/** what is reviewed was parsed into screens, the payload is the review type and the number of screens. */
+	TRACE_PARSE,
+	/** the UI changed state, the payload is the new state. */
+	TRACE_UI_STATE,
+	/** a signature was made, the payload is its length. */
+	TRACE_SIGN
+};
+
+/** number of events kept in RAM, the oldest one is replaced first. */
+#define TRACE_SIZE 32
+
+/** max number of events in the response to a drain request, the header and the events must fit in the response. */
+#define TRACE_DRAIN_EVENTS 16
+
+/** length of an event in the response, the tick (4 bytes big endian), the event and the payload (3 bytes big endian). */
+#define TRACE_EVENT_LEN 8
+
+#ifdef HAVE_TRACE
+
+/** records the event with the low 24 bits of payload, and the current tick. */
+#define TRACE(event, payload) trace_add(event, payload)
+
+/** counts a ticker event, the time of the events. */
+#define TRACE_TICK() trace_tick()
+
+/** records the event with the low 24 bits of payload, and the current tick. */
+void trace_add(enum TRACE_EVENT event, unsigned int payload);
+
+/** counts a ticker event. */
+void trace_tick(void);
+
+/**
+ * writes the number of events that were replaced before they were drained (2 bytes big endian), the number of events
+ * that follow (1 byte) and up to TRACE_DRAIN_EVENTS of the oldest events to out, forgets them, and returns the length written.
+ */
+unsigned int trace_drain(unsigned char * out);
+
+#else // HAVE_TRACE
+
+/** records the event, only with HAVE_TRACE. */
+#define TRACE(event, payload)
+
+/** counts a ticker event, only with HAVE_TRACE. */
+#define TRACE_TICK()
+
+#endif // HAVE_TRACE
+
+#endif // TRACE_H
@@ -4,17 +4,50 @@
 
 #include "ui.h"
 #include "glyphs.h"
+#include "keys.h"
+#include "signature_cache.h"
+#include "batch.h"
+#include "policy.h"
+#include "message.h"
+#include "cpx.h"
+#include "scratch.h"
+#include "audit_log.h"
+#include "allow_list.h"
+#include "settings.h"
+#include "call_counts.h"
+#include "trace.h"
 
 /** default font */
 #define DEFAULT_FONT BAGL_FONT_OPEN_SANS_EXTRABOLD_11px | BAGL_FONT_ALIGNMENT_CENTER
 
 #define DEFAULT_FONT_BLUE BAGL_FONT_OPEN_SANS_LIGHT_14px | BAGL_FONT_ALIGNMENT_CENTER | BAGL_FONT_ALIGNMENT_MIDDLE
 
+/** max width of the page number, "nn/nn". */
+#define MAX_PAGE_TEXT_WIDTH 6
+
+/** max page number shown in the page number, so it fits in two digits, a field has far fewer pages. */
+#define MAX_PAGE_NUMBER 99
+
+/** max width of the account number, the 10 digits of a 31 bit index and the terminating zero. */
+#define MAX_ACCOUNT_TEXT_WIDTH 11
+
+/** elements of the public key screens that show the address, the first and second line. */
+#define PUBLIC_KEY_LINE_ELEMENTS ((1 << 1) | (1 << 2))
+
+/** userid of the elements of the review template shown on all review screens. */
+#define REVIEW_ELEMENT_ALL 0x00
+
+/** userid of the elements of the review template shown on the action screens, with the texts of the review type. */
+#define REVIEW_ELEMENT_ACTION 0x01
+
+/** userid of the elements of the review template shown on the pages of what is being reviewed. */
+#define REVIEW_ELEMENT_DESC 0x02
+
 /** text description font. */
 #define TX_DESC_FONT BAGL_FONT_OPEN_SANS_REGULAR_11px | BAGL_FONT_ALIGNMENT_CENTER
 
-/** the timer */
-int exit_timer;
+/** the timer, the seconds left before the app exits */
+unsigned int exit_timer;
 
 /** display for the timer */
 char timer_desc[MAX_TIMER_TEXT_WIDTH];
@@ -22,6 +55,15 @@ char timer_desc[MAX_TIMER_TEXT_WIDTH];
 /** UI state enum */
 enum UI_STATE uiState;
 
+/** sets the UI state, and records the change in the trace. */
+static void set_ui_state(enum UI_STATE state) {
+	uiState = state;
+	TRACE(TRACE_UI_STATE, state);
+}
+
+/** review type enum */
+enum REVIEW_TYPE review_type;
+
 /** UI state flag */
 #ifdef TARGET_NANOX
 #include "ux.h"
@@ -40,6 +82,9 @@ unsigned char publicKeyNeedsRefresh;
 /** the hash. */
 cx_sha256_t hash;
 
+/** the hash result of the transaction being signed. */
+unsigned char tx_hash[SHA256_HASH_LEN];
+
 /** index of the current screen. */
 unsigned int curr_scr_ix;
 
@@ -55,31 +100,109 @@ unsigned int raw_tx_ix;
 /** current length of raw transaction. */
 unsigned int raw_tx_len;
 
-/** all text descriptions. */
-char tx_desc[MAX_TX_TEXT_SCREENS][MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
+/** length of the transaction in raw_tx, without the trailing BIP44 paths. */
+unsigned int raw_tx_body_len;
+
+/** number of BIP44 paths to sign the transaction with. */
+unsigned char sign_path_count;
 
 /** currently displayed text description. */
-char curr_tx_desc[MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
+char curr_tx_desc[TX_DESC_PAGE_LINES][MAX_TX_TEXT_WIDTH];
+
+/** index of the displayed page of the current screen. */
+static unsigned int curr_page_ix;
+
+/** number of pages of the current screen. */
+static unsigned int curr_page_count;
+
+/** page number of the current screen, blank if it has a single page. */
+static char curr_page_desc[MAX_PAGE_TEXT_WIDTH];
+
+/** what both buttons do on a review screen, Nano S. */
+enum REVIEW_ACTION {
+	REVIEW_ACTION_NONE, REVIEW_ACTION_APPROVE, REVIEW_ACTION_DENY
+};
+
+/** which text of the review type a review screen shows, Nano S. */
+enum REVIEW_TEXT {
+	REVIEW_TEXT_NONE, REVIEW_TEXT_TOP, REVIEW_TEXT_APPROVE, REVIEW_TEXT_DENY
+};
+
+/** a review screen, Nano S: its text, the screens the Left and Right buttons lead to, and what both buttons do. */
+typedef struct {
+	/** centered text of the screen, none on the screens of what is being reviewed. */
+	enum REVIEW_TEXT text;
+	enum UI_STATE up;
+	enum UI_STATE down;
+	enum REVIEW_ACTION action;
+} review_screen_t;
+
+/**
+ * the review screens, from UI_TOP_SIGN to UI_DENY, one row each.
+ * on UI_TX_DESC the buttons first move through the pages of what is being reviewed, and only leave it at either end.
+ */
+static const review_screen_t REVIEW_SCREENS[] = {
+	/* UI_TOP_SIGN */ { REVIEW_TEXT_TOP, UI_DENY, UI_TX_DESC, REVIEW_ACTION_APPROVE },
+	/* UI_TX_DESC */ { REVIEW_TEXT_NONE, UI_TOP_SIGN, UI_SIGN, REVIEW_ACTION_NONE },
+	/* UI_SIGN */ { REVIEW_TEXT_APPROVE, UI_TX_DESC, UI_DENY, REVIEW_ACTION_APPROVE },
+	/* UI_DENY */ { REVIEW_TEXT_DENY, UI_SIGN, UI_TOP_SIGN, REVIEW_ACTION_DENY },
+};
+
+/**
+ * the texts of the action screens of each review type, in the order of REVIEW_TYPE, Nano S: the top screen, which
+ * approves without going through what is reviewed, the approve screen and the deny screen.
+ * each type says what approving does, so approving a policy or a recipient never reads as signing a transaction.
+ */
+static const char * const REVIEW_TEXTS[][REVIEW_TEXT_DENY] = {
+	/* REVIEW_TX */ { "Sign Tx Now", "Sign Tx", "Deny Tx" },
+	/* REVIEW_BATCH */ { "Sign Batch Now", "Sign Batch", "Deny Batch" },
+	/* REVIEW_POLICY */ { "Approve Policy", "Approve Policy", "Deny Policy" },
+	/* REVIEW_MESSAGE */ { "Sign Message Now", "Sign Message", "Deny Message" },
+	/* REVIEW_RECIPIENT */ { "Add Recipient", "Add Recipient", "Deny Recipient" },
+	/* REVIEW_EXIT_TIMEOUT */ { "Set Timeout", "Set Timeout", "Deny Timeout" },
+};
+
+/** row of REVIEW_SCREENS for a review state. */
+#define REVIEW_SCREEN(state) (&REVIEW_SCREENS[(state) - UI_TOP_SIGN])
 
 /** currently displayed public key */
 char current_public_key[MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
 
+/** elements of the displayed screen sent by a partial redisplay, one bit per element index, all of them if 0. */
+static unsigned int redisplay_elements;
+
+/** account level path of the extended public key waiting for export confirmation */
+static unsigned int export_path[ACCOUNT_PATH_LEN];
+
+/** account number of the extended public key waiting for export confirmation */
+static char export_account_desc[MAX_ACCOUNT_TEXT_WIDTH];
+
 /** UI was touched indicating the user wants to exit the app */
 static const bagl_element_t * io_seproxyhal_touch_exit(const bagl_element_t *e);
 
+/** UI was touched indicating the user wants to sign what is being reviewed, a transaction or a batch */
+static const bagl_element_t * io_seproxyhal_touch_review_approve(const bagl_element_t *e);
+
+/** UI was touched indicating the user wants to approve the batch */
+static const bagl_element_t * io_seproxyhal_touch_batch_approve(const bagl_element_t *e);
+
+/** UI was touched indicating the user wants to start the spending policy */
+static const bagl_element_t * io_seproxyhal_touch_policy_approve(const bagl_element_t *e);
+
+/** UI was touched indicating the user wants to sign the message */
+static const bagl_element_t * io_seproxyhal_touch_message_approve(const bagl_element_t *e);
+
 /** UI was touched indicating the user wants to deny te signature request */
 static const bagl_element_t * io_seproxyhal_touch_deny(const bagl_element_t *e);
 
-/** display part of the transaction description */
-static void ui_display_tx_desc_single_page(void);
-static void ui_display_tx_desc_1(void);
-static void ui_display_tx_desc_2(void);
+/** UI was touched indicating the user wants to export the extended public key */
+static const bagl_element_t * io_seproxyhal_touch_export_approve(const bagl_element_t *e);
 
-/** display the UI for signing a transaction */
-static void ui_sign(void);
+/** UI was touched indicating the user wants to deny the extended public key export */
+static const bagl_element_t * io_seproxyhal_touch_export_deny(const bagl_element_t *e);
 
-/** display the UI for denying a transaction */
-static void ui_deny(void);
+/** display a review screen, on UI_TX_DESC the current page of what is being reviewed */
+static void ui_display_review(enum UI_STATE state);
 
 /** show the public key screen */
 static void ui_public_key_1(void);
@@ -99,64 +222,112 @@ static void clear_tx_desc(void);
 ////////////////////////////////////  NANO X //////////////////////////////////////////////////
 #ifdef TARGET_NANOX
 
+/** title of the review, after "Review". */
+static char review_title[MAX_TX_TEXT_WIDTH];
+
+/** true while the review flow is on the screens of what is being reviewed, false on the steps around them. */
+static bool review_flow_inside;
+
+/** entering the upper delimiter, Nano X: load the page before the field step and go back to it, or leave the screens upwards. */
+static void review_flow_upper_delimiter(void);
+
+/** entering the lower delimiter, Nano X: load the page after the field step and go back to it, or leave the screens downwards. */
+static void review_flow_lower_delimiter(void);
+
 UX_STEP_NOCB(
-    ux_confirm_single_flow_1_step, 
-    pnn, 
+    ux_review_flow_1_step,
+    pnn,
     {
       &C_icon_eye,
       "Review",
-      "Transaction"
+      review_title
     });
-UX_STEP_NOCB(
-    ux_confirm_single_flow_2_step, 
-    bn, 
+UX_STEP_INIT(
+    ux_review_flow_upper_delimiter,
+    NULL,
+    NULL,
     {
-      "Type",
-      tx_desc[0][1]
+      review_flow_upper_delimiter();
     });
+// a single step for all the screens, filled with the current page when a delimiter is entered.
 UX_STEP_NOCB(
-    ux_confirm_single_flow_3_step, 
-    bnn, 
+    ux_review_flow_field_step,
+    bnnn,
     {
-      "Amount",
-      tx_desc[1][0],
-      tx_desc[1][1],
+      curr_tx_desc[0],
+      curr_tx_desc[1],
+      curr_tx_desc[2],
+      curr_tx_desc[3]
     });
-UX_STEP_NOCB(
-    ux_confirm_single_flow_4_step, 
-    bnnn, 
+UX_STEP_INIT(
+    ux_review_flow_lower_delimiter,
+    NULL,
+    NULL,
     {
-      "Destination Address",
-      tx_desc[2][0],
-      tx_desc[2][1],
-      tx_desc[2][2]
+      review_flow_lower_delimiter();
     });
 UX_STEP_VALID(
-    ux_confirm_single_flow_5_step, 
+    ux_review_flow_accept_step,
     pb,
-    io_seproxyhal_touch_approve(NULL), 
+    io_seproxyhal_touch_review_approve(NULL),
     {
       &C_icon_validate_14,
       "Accept",
     });
 UX_STEP_VALID(
-    ux_confirm_single_flow_6_step, 
-    pb, 
+    ux_review_flow_reject_step,
+    pb,
     io_seproxyhal_touch_deny(NULL),
     {
       &C_icon_crossmark,
       "Reject",
     });
-UX_FLOW(ux_confirm_single_flow,
-  &ux_confirm_single_flow_1_step,
-  &ux_confirm_single_flow_2_step,
-  &ux_confirm_single_flow_3_step,
-  &ux_confirm_single_flow_4_step,
-  &ux_confirm_single_flow_5_step,
-  &ux_confirm_single_flow_6_step
+UX_FLOW(ux_review_flow,
+  &ux_review_flow_1_step,
+  &ux_review_flow_upper_delimiter,
+  &ux_review_flow_field_step,
+  &ux_review_flow_lower_delimiter,
+  &ux_review_flow_accept_step,
+  &ux_review_flow_reject_step
 );
 
-
+UX_STEP_NOCB(
+    ux_export_public_key_flow_1_step,
+    pnn,
+    {
+      &C_icon_eye,
+      "Export",
+      "Account Key"
+    });
+UX_STEP_NOCB(
+    ux_export_public_key_flow_2_step,
+    bn,
+    {
+      "Account",
+      export_account_desc
+    });
+UX_STEP_VALID(
+    ux_export_public_key_flow_3_step,
+    pb,
+    io_seproxyhal_touch_export_approve(NULL),
+    {
+      &C_icon_validate_14,
+      "Approve",
+    });
+UX_STEP_VALID(
+    ux_export_public_key_flow_4_step,
+    pb,
+    io_seproxyhal_touch_export_deny(NULL),
+    {
+      &C_icon_crossmark,
+      "Reject",
+    });
+UX_FLOW(ux_export_public_key_flow,
+  &ux_export_public_key_flow_1_step,
+  &ux_export_public_key_flow_2_step,
+  &ux_export_public_key_flow_3_step,
+  &ux_export_public_key_flow_4_step
+);
 
 UX_STEP_NOCB(
     ux_display_public_flow_step, 
@@ -214,7 +385,7 @@ UX_STEP_NOCB(
 UX_STEP_VALID(
     ux_idle_flow_4_step,
     pb,
-    os_sched_exit(-1),
+    io_seproxyhal_touch_exit(NULL),
     {
       &C_icon_dashboard,
       "Quit",
@@ -334,229 +505,88 @@ static unsigned int bagl_ui_public_key_nanos_2_button(unsigned int button_mask,
 	return 0;
 }
 
-
-/** UI struct for the top "Sign Transaction" screen, Nano S */
-static const bagl_element_t bagl_ui_top_sign_nanos[] = {
+/** UI struct for the "Export Account Key" screen, Nano S */
+static const bagl_element_t bagl_ui_export_public_key_nanos[] = {
 // { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
 // text, touch_area_brim, overfgcolor, overbgcolor, tap, out, over,
 // },
 	{	{	BAGL_RECTANGLE, 0x00, 0, 0, 128, 32, 0, 0, BAGL_FILL, 0x000000, 0xFFFFFF, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* top left bar */
-	{	{	BAGL_RECTANGLE, 0x00, 3, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* top right bar */
-	{	{	BAGL_RECTANGLE, 0x00, 113, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* center text */
-	{	{	BAGL_LABELINE, 0x02, 0, 20, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, "Sign Tx Now", 0, 0, 0, NULL, NULL, NULL, },
-	/* left icon is up arrow  */
-	{	{	BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* right icon is down arrow */
-	{	{	BAGL_ICON, 0x00, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL, 0, 0, 0, NULL, NULL, NULL, },
+	/* first line of the export request */
+	{	{	BAGL_LABELINE, 0x02, 10, 12, 108, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, "Export Account", 0, 0, 0, NULL, NULL, NULL, },
+	/* second line of the export request, the account number */
+	{	{	BAGL_LABELINE, 0x02, 10, 26, 108, 11, 0, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, export_account_desc, 0, 0, 0, NULL, NULL, NULL, },
+	/* left icon is a X */
+	{	{	BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_CROSS }, NULL, 0, 0, 0, NULL, NULL, NULL, },
+	/* right icon is a check */
+	{	{	BAGL_ICON, 0x00, 117, 12, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_CHECK }, NULL, 0, 0, 0, NULL, NULL, NULL, },
 /* */
 };
 
 /**
- * buttons for the top "Sign Transaction" screen, Nano S
+ * buttons for the "Export Account Key" screen, Nano S
  *
- * up on Left button, down on right button, sign on both buttons.
+ * deny on Left button, export on Right button.
  */
-static unsigned int bagl_ui_top_sign_nanos_button(unsigned int button_mask, unsigned int button_mask_counter) {
+static unsigned int bagl_ui_export_public_key_nanos_button(unsigned int button_mask, unsigned int button_mask_counter) {
 	switch (button_mask) {
-	case BUTTON_EVT_RELEASED | BUTTON_LEFT | BUTTON_RIGHT:
-		io_seproxyhal_touch_approve(NULL);
-		break;
-
 	case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
-		tx_desc_dn(NULL);
+		io_seproxyhal_touch_export_approve(NULL);
 		break;
-
 	case BUTTON_EVT_RELEASED | BUTTON_LEFT:
-		tx_desc_up(NULL);
+		io_seproxyhal_touch_export_deny(NULL);
 		break;
 	}
 	return 0;
 }
 
-/** UI struct for the bottom "Sign Transaction" screen, Nano S. */
-static const bagl_element_t bagl_ui_sign_nanos[] = {
-// { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
-// text, touch_area_brim, overfgcolor, overbgcolor, tap, out, over,
-// },
-	{	{	BAGL_RECTANGLE, 0x00, 0, 0, 128, 32, 0, 0, BAGL_FILL, 0x000000, 0xFFFFFF, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* top left bar */
-	{	{	BAGL_RECTANGLE, 0x00, 3, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* top right bar */
-	{	{	BAGL_RECTANGLE, 0x00, 113, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* center text */
-	{	{	BAGL_LABELINE, 0x02, 0, 20, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, "Sign Tx", 0, 0, 0, NULL, NULL, NULL, },
-	/* left icon is up arrow  */
-	{	{	BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* right icon is down arrow */
-	{	{	BAGL_ICON, 0x00, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-/* */
-};
-
 /**
- * buttons for the bottom "Sign Transaction" screen, Nano S
- *
- * up on Left button, down on right button, sign on both buttons.
+ * UI struct for all the review screens, Nano S.
+ * review_preprocessor only sends the elements tagged for the current screen, and the text of the action screens.
  */
-static unsigned int bagl_ui_sign_nanos_button(unsigned int button_mask, unsigned int button_mask_counter) {
-	switch (button_mask) {
-	case BUTTON_EVT_RELEASED | BUTTON_LEFT | BUTTON_RIGHT:
-		io_seproxyhal_touch_approve(NULL);
-		break;
-
-	case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
-		tx_desc_dn(NULL);
-		break;
-
-	case BUTTON_EVT_RELEASED | BUTTON_LEFT:
-		tx_desc_up(NULL);
-		break;
-	}
-	return 0;
-}
-
-/** UI struct for the bottom "Deny Transaction" screen, Nano S */
-static const bagl_element_t bagl_ui_deny_nanos[] = {
+static const bagl_element_t bagl_ui_review_nanos[] = {
 // { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
 // text, touch_area_brim, overfgcolor, overbgcolor, tap, out, over,
 // },
-	{	{	BAGL_RECTANGLE, 0x00, 0, 0, 128, 32, 0, 0, BAGL_FILL, 0x000000, 0xFFFFFF, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
+	{	{	BAGL_RECTANGLE, REVIEW_ELEMENT_ALL, 0, 0, 128, 32, 0, 0, BAGL_FILL, 0x000000, 0xFFFFFF, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
 	/* top left bar */
-	{	{	BAGL_RECTANGLE, 0x00, 3, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
+	{	{	BAGL_RECTANGLE, REVIEW_ELEMENT_ACTION, 3, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
 	/* top right bar */
-	{	{	BAGL_RECTANGLE, 0x00, 113, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* center text */
-	{	{	BAGL_LABELINE, 0x02, 0, 20, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, "Deny Tx", 0, 0, 0, NULL, NULL, NULL, },
+	{	{	BAGL_RECTANGLE, REVIEW_ELEMENT_ACTION, 113, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
+	/* center text, from the review screen table */
+	{	{	BAGL_LABELINE, REVIEW_ELEMENT_ACTION, 0, 20, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
+	/* page number, blank if the screen has a single page */
+	{	{	BAGL_LABELINE, REVIEW_ELEMENT_DESC, 0, 10, 20, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, curr_page_desc, 0, 0, 0, NULL, NULL, NULL, },
+	/* first line of the page */
+	{	{	BAGL_LABELINE, REVIEW_ELEMENT_DESC, 10, 15, 108, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, curr_tx_desc[0], 0, 0, 0, NULL, NULL, NULL, },
+	/* second line of the page */
+	{	{	BAGL_LABELINE, REVIEW_ELEMENT_DESC, 10, 26, 108, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, curr_tx_desc[1], 0, 0, 0, NULL, NULL, NULL, },
 	/* left icon is up arrow  */
-	{	{	BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	{	{	BAGL_ICON, 0x00, 117, 13, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-/* */
-};
-
-/**
- * buttons for the bottom "Deny Transaction" screen, Nano S
- *
- * up on Left button, down on right button, deny on both buttons.
- */
-static unsigned int bagl_ui_deny_nanos_button(unsigned int button_mask, unsigned int button_mask_counter) {
-	switch (button_mask) {
-	case BUTTON_EVT_RELEASED | BUTTON_LEFT | BUTTON_RIGHT:
-		io_seproxyhal_touch_deny(NULL);
-		break;
-
-	case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
-		tx_desc_dn(NULL);
-		break;
-
-	case BUTTON_EVT_RELEASED | BUTTON_LEFT:
-		tx_desc_up(NULL);
-		break;
-	}
-	return 0;
-}
-
-/** UI struct for the transaction description single page screen, Nano S */
-static const bagl_element_t bagl_ui_tx_desc_nanos_single_page[] = {
-// { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
-// text, touch_area_brim, overfgcolor, overbgcolor, tap, out, over,
-// },
-	{	{	BAGL_RECTANGLE, 0x00, 0, 0, 128, 32, 0, 0, BAGL_FILL, 0x000000, 0xFFFFFF, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* screen 1 number */
-	{	{	BAGL_LABELINE, 0x02, 0, 10, 20, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, 0, 0, 0, 0, NULL, NULL, NULL, },
-	/* first line of description of current screen */
-	{	{	BAGL_LABELINE, 0x02, 10, 15, 108, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, curr_tx_desc[0], 0, 0, 0, NULL, NULL, NULL, },
-	/* second line of description of current screen */
-	{	{	BAGL_LABELINE, 0x02, 10, 26, 108, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, curr_tx_desc[1], 0, 0, 0, NULL, NULL, NULL, },
-	/* left icon is up arrow  */
-	{	{	BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL, 0, 0, 0, NULL, NULL, NULL, },
+	{	{	BAGL_ICON, REVIEW_ELEMENT_ALL, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL, 0, 0, 0, NULL, NULL, NULL, },
 	/* right icon is down arrow */
-	{	{	BAGL_ICON, 0x00, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL, 0, 0, 0, NULL, NULL, NULL, },
+	{	{	BAGL_ICON, REVIEW_ELEMENT_ALL, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL, 0, 0, 0, NULL, NULL, NULL, },
 /* */
 };
 
 /**
- * buttons for the transaction description single page screen, Nano S
+ * buttons for all the review screens, Nano S
  *
- * up on Left button, down on right button.
+ * up on Left button, down on right button, the action of the screen on both buttons.
  */
-static unsigned int bagl_ui_tx_desc_nanos_single_page_button(unsigned int button_mask, unsigned int button_mask_counter) {
+static unsigned int bagl_ui_review_nanos_button(unsigned int button_mask, unsigned int button_mask_counter) {
 	switch (button_mask) {
-	case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
-		tx_desc_dn(NULL);
-		break;
-
-	case BUTTON_EVT_RELEASED | BUTTON_LEFT:
-		tx_desc_up(NULL);
-		break;
-	}
-	return 0;
-}
-
-/** UI struct for the transaction description two page screen, Nano S */
-static const bagl_element_t bagl_ui_tx_desc_nanos_1[] = {
-// { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
-// text, touch_area_brim, overfgcolor, overbgcolor, tap, out, over,
-// },
-	{	{	BAGL_RECTANGLE, 0x00, 0, 0, 128, 32, 0, 0, BAGL_FILL, 0x000000, 0xFFFFFF, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* screen 1 number */
-	{	{	BAGL_LABELINE, 0x02, 0, 10, 20, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, "1/2", 0, 0, 0, NULL, NULL, NULL, },
-	/* first line of description of current screen */
-	{	{	BAGL_LABELINE, 0x02, 10, 15, 108, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, curr_tx_desc[0], 0, 0, 0, NULL, NULL, NULL, },
-	/* second line of description of current screen */
-	{	{	BAGL_LABELINE, 0x02, 10, 26, 108, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, curr_tx_desc[1], 0, 0, 0, NULL, NULL, NULL, },
-	/* left icon is up arrow  */
-	{	{	BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* right icon is down arrow */
-	{	{	BAGL_ICON, 0x00, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-/* */
-};
-
-/** UI struct for the transaction description two page screen, Nano S */
-static const bagl_element_t bagl_ui_tx_desc_nanos_2[] = {
-// { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
-// text, touch_area_brim, overfgcolor, overbgcolor, tap, out, over,
-// },
-	{	{	BAGL_RECTANGLE, 0x00, 0, 0, 128, 32, 0, 0, BAGL_FILL, 0x000000, 0xFFFFFF, 0, 0 }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* screen 2 number */
-	{	{	BAGL_LABELINE, 0x02, 0, 10, 20, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, "2/2", 0, 0, 0, NULL, NULL, NULL, },
-	/* second line of description of current screen */
-	{	{	BAGL_LABELINE, 0x02, 10, 15, 108, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, curr_tx_desc[1], 0, 0, 0, NULL, NULL, NULL, },
-	/* third line of description of current screen  */
-	{	{	BAGL_LABELINE, 0x02, 10, 26, 108, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, curr_tx_desc[2], 0, 0, 0, NULL, NULL, NULL, },
-	/* left icon is up arrow  */
-	{	{	BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-	/* right icon is down arrow */
-	{	{	BAGL_ICON, 0x00, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL, 0, 0, 0, NULL, NULL, NULL, },
-/* */
-};
-
-/**
- * buttons for the transaction description screen 1, Nano S
- *
- * up on Left button, down on right button.
- */
-static unsigned int bagl_ui_tx_desc_nanos_1_button(unsigned int button_mask, unsigned int button_mask_counter) {
-	switch (button_mask) {
-	case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
-		tx_desc_dn(NULL);
-		break;
-
-	case BUTTON_EVT_RELEASED | BUTTON_LEFT:
-		tx_desc_up(NULL);
+	case BUTTON_EVT_RELEASED | BUTTON_LEFT | BUTTON_RIGHT:
+		switch (REVIEW_SCREEN(uiState)->action) {
+		case REVIEW_ACTION_APPROVE:
+			io_seproxyhal_touch_review_approve(NULL);
+			break;
+		case REVIEW_ACTION_DENY:
+			io_seproxyhal_touch_deny(NULL);
+			break;
+		default:
+			break;
+		}
 		break;
-	}
-	return 0;
-}
 
-/**
- * buttons for the transaction description screen 2, Nano S
- *
- * up on Left button, down on right button.
- */
-static unsigned int bagl_ui_tx_desc_nanos_2_button(unsigned int button_mask, unsigned int button_mask_counter) {
-	switch (button_mask) {
 	case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
 		tx_desc_dn(NULL);
 		break;
@@ -570,187 +600,154 @@ static unsigned int bagl_ui_tx_desc_nanos_2_button(unsigned int button_mask, uns
 
 /** if the user wants to exit go back to the app dashboard. */
 static const bagl_element_t *io_seproxyhal_touch_exit(const bagl_element_t *e) {
+	wipe_session();
 	// Go back to the dashboard
 	os_sched_exit(0);
 	return NULL; // do not redraw the widget
 }
 
-/** copy the current row of the tx_desc buffer into curr_tx_desc to display on the screen */
-static void copy_tx_desc(void) {
-	os_memmove(curr_tx_desc, tx_desc[curr_scr_ix], CURR_TX_DESC_LEN);
-	curr_tx_desc[0][MAX_TX_TEXT_WIDTH - 1] = '\0';
-	curr_tx_desc[1][MAX_TX_TEXT_WIDTH - 1] = '\0';
-	curr_tx_desc[2][MAX_TX_TEXT_WIDTH - 1] = '\0';
+/** renders the current screen, and goes to its first or last page. */
+static void load_curr_tx_desc(bool last_page) {
+	curr_page_count = load_tx_desc_screen(curr_scr_ix);
+	curr_page_ix = last_page ? (curr_page_count - 1) : 0;
 }
 
-/** copy the current row of the tx_desc buffer into curr_tx_desc to display on the screen */
-static void copy_tx_desc_single_page(void) {
-	os_memmove(curr_tx_desc, tx_desc[curr_scr_ix], CURR_TX_DESC_LEN);
-	curr_tx_desc[0][MAX_TX_TEXT_WIDTH - 1] = '\0';
-	curr_tx_desc[1][MAX_TX_TEXT_WIDTH - 1] = '\0';
+/** moves to the previous page of what is being reviewed, returns false on the first page of the first screen. */
+static bool tx_desc_prev_page(void) {
+	if (curr_page_ix > 0) {
+		curr_page_ix--;
+	} else if (curr_scr_ix > 0) {
+		curr_scr_ix--;
+		load_curr_tx_desc(true);
+	} else {
+		return false;
+	}
+	return true;
 }
 
-/** processes the Up button, Nano S */
-static const bagl_element_t * tx_desc_up(const bagl_element_t *e) {
-	switch (uiState) {
-	case UI_TOP_SIGN:
-		ui_deny();
-		break;
-
-	case UI_TX_DESC_1:
-		if (curr_scr_ix == 0) {
-			ui_top_sign();
-		} else {
-			curr_scr_ix--;
-			if (screen_index_page_type[curr_scr_ix] == SINGLE_PAGE) {
-				copy_tx_desc_single_page();
-				ui_display_tx_desc_single_page();
-			} else {
-				copy_tx_desc();
-				ui_display_tx_desc_2();
-			}
-		}
-		break;
-
-	case UI_TX_DESC_2:
-		ui_display_tx_desc_1();
-		break;
-
-
-	case UI_TX_DESC_SINGLE_PAGE:
-		if (curr_scr_ix == 0) {
-			ui_top_sign();
-		} else {
-			curr_scr_ix--;
-			if (screen_index_page_type[curr_scr_ix] == SINGLE_PAGE) {
-				copy_tx_desc_single_page();
-				ui_display_tx_desc_single_page();
-			} else {
-				copy_tx_desc();
-				ui_display_tx_desc_2();
-			}
-		}
-		break;
-
-	case UI_SIGN:
-		curr_scr_ix = max_scr_ix - 1;
-		if (screen_index_page_type[curr_scr_ix] == SINGLE_PAGE) {
-			copy_tx_desc_single_page();
-			ui_display_tx_desc_single_page();
-		} else {
-			copy_tx_desc();
-			ui_display_tx_desc_1();
-		}
-		break;
+/** moves to the next page of what is being reviewed, returns false on the last page of the last screen. */
+static bool tx_desc_next_page(void) {
+	if (curr_page_ix + 1 < curr_page_count) {
+		curr_page_ix++;
+	} else if (curr_scr_ix + 1 < max_scr_ix) {
+		curr_scr_ix++;
+		load_curr_tx_desc(false);
+	} else {
+		return false;
+	}
+	return true;
+}
 
-	case UI_DENY:
-		ui_sign();
-		break;
+/** shows the review screen, entering the screens of what is being reviewed at their last page if from_below, otherwise at their first. */
+static void ui_review_goto(enum UI_STATE state, bool from_below) {
+	if (state == UI_TX_DESC) {
+		curr_scr_ix = from_below ? (max_scr_ix - 1) : 0;
+		load_curr_tx_desc(from_below);
+	}
+	ui_display_review(state);
+}
 
-	default:
+/** processes the Up button, Nano S */
+static const bagl_element_t * tx_desc_up(const bagl_element_t *e) {
+	if (!is_reviewing_tx()) {
 		hashTainted = 1;
 		THROW(0x6D02);
-		break;
+	}
+	if ((uiState == UI_TX_DESC) && tx_desc_prev_page()) {
+		ui_display_review(UI_TX_DESC);
+	} else {
+		ui_review_goto(REVIEW_SCREEN(uiState)->up, true);
 	}
 	return NULL;
 }
 
 /** processes the Down button, Nano S */
 static const bagl_element_t * tx_desc_dn(const bagl_element_t *e) {
-	switch (uiState) {
-	case UI_TOP_SIGN:
-		curr_scr_ix = 0;
-		if (screen_index_page_type[curr_scr_ix] == SINGLE_PAGE) {
-			copy_tx_desc_single_page();
-			ui_display_tx_desc_single_page();
-		} else {
-			copy_tx_desc();
-			ui_display_tx_desc_1();
-		}
-		break;
-
-	case UI_TX_DESC_SINGLE_PAGE:
-		if (curr_scr_ix == max_scr_ix - 1) {
-			ui_sign();
-		} else {
-			curr_scr_ix++;
-			if (screen_index_page_type[curr_scr_ix] == SINGLE_PAGE) {
-				copy_tx_desc_single_page();
-				ui_display_tx_desc_single_page();
-			} else {
-				copy_tx_desc();
-				ui_display_tx_desc_1();
-			}
-		}
-		break;
-
-	case UI_TX_DESC_1:
-		ui_display_tx_desc_2();
-		break;
-
-	case UI_TX_DESC_2:
-		if (curr_scr_ix == max_scr_ix - 1) {
-			ui_sign();
-		} else {
-			curr_scr_ix++;
-			if (screen_index_page_type[curr_scr_ix] == SINGLE_PAGE) {
-				copy_tx_desc_single_page();
-				ui_display_tx_desc_single_page();
-			} else {
-				copy_tx_desc();
-				ui_display_tx_desc_1();
-			}
-		}
-		break;
-
-	case UI_SIGN:
-		ui_deny();
-		break;
-
-	case UI_DENY:
-		ui_top_sign();
-		break;
-
-	default:
+	if (!is_reviewing_tx()) {
 		hashTainted = 1;
 		THROW(0x6D01);
-		break;
+	}
+	if ((uiState == UI_TX_DESC) && tx_desc_next_page()) {
+		ui_display_review(UI_TX_DESC);
+	} else {
+		ui_review_goto(REVIEW_SCREEN(uiState)->down, false);
 	}
 	return NULL;
 }
 
+#if defined(TARGET_NANOX)
+static void review_flow_upper_delimiter(void) {
+	if (!review_flow_inside) {
+		// coming down from the top of the flow, start at the first page.
+		review_flow_inside = true;
+		curr_scr_ix = 0;
+		load_curr_tx_desc(false);
+	} else if (!tx_desc_prev_page()) {
+		review_flow_inside = false;
+		ux_flow_prev();
+		return;
+	}
+	load_tx_desc_page(curr_page_ix);
+	ux_flow_next();
+}
+
+static void review_flow_lower_delimiter(void) {
+	if (!review_flow_inside) {
+		// coming up from the approval steps, start at the last page.
+		review_flow_inside = true;
+		curr_scr_ix = max_scr_ix - 1;
+		load_curr_tx_desc(true);
+	} else if (!tx_desc_next_page()) {
+		review_flow_inside = false;
+		ux_flow_next();
+		return;
+	}
+	load_tx_desc_page(curr_page_ix);
+	ux_flow_prev();
+}
+#endif // TARGET_NANOX
+
 /** processes the transaction approval. the UI is only displayed when all of the TX has been sent over for signing. */
 const bagl_element_t*io_seproxyhal_touch_approve(const bagl_element_t *e) {
 	unsigned int tx = 0;
 
 	if (G_io_apdu_buffer[2] == P1_LAST) {
-		unsigned int raw_tx_len_except_bip44 = raw_tx_len - BIP44_BYTE_LENGTH;
-		unsigned char * bip44_in = raw_tx + raw_tx_len_except_bip44;
-
-		/** BIP44 path, used to derive the private key from the mnemonic by calling os_perso_derive_node_bip32. */
-		unsigned int bip44_path[BIP44_PATH_LEN];
-		uint32_t i;
-		for (i = 0; i < BIP44_PATH_LEN; i++) {
-			bip44_path[i] = (bip44_in[0] << 24) | (bip44_in[1] << 16) | (bip44_in[2] << 8) | (bip44_in[3]);
-			bip44_in += 4;
+		scratch_begin(SCRATCH_SIGN);
+
+		// with several paths, each signature is prefixed with its length.
+		const bool multi_path = (G_io_apdu_buffer[3] == P2_MULTI_PATH);
+		unsigned char * bip44_in = raw_tx + raw_tx_body_len;
+
+		for (unsigned int path_ix = 0; path_ix < sign_path_count; path_ix++) {
+			/** BIP44 path, used to derive the private key from the mnemonic by calling os_perso_derive_node_bip32. */
+			unsigned int bip44_path[BIP44_PATH_LEN];
+			read_bip44_path(bip44_in, bip44_path);
+			bip44_in += BIP44_BYTE_LENGTH;
+
+			cx_ecfp_private_key_t privateKey;
+			derive_private_key(bip44_path, &privateKey);
+
+			// sign the hash, computed when the last part of the transaction arrived.
+			unsigned char * out = G_io_apdu_buffer + tx + (multi_path ? 1 : 0);
+			COUNT_CALL(CALL_COUNT_ECDSA_SIGN);
+			unsigned int signature_len = cx_ecdsa_sign(&privateKey,  CX_RND_RFC6979 | CX_LAST, CX_SHA256, tx_hash, sizeof(tx_hash), out,
+					sizeof(G_io_apdu_buffer) - (out - G_io_apdu_buffer), NULL);
+			TRACE(TRACE_SIGN, signature_len);
+			signature_cache_put(tx_hash, bip44_path, out, signature_len);
+
+			// clear private key data
+			release_private_key(&privateKey);
+
+			if (multi_path) {
+				G_io_apdu_buffer[tx++] = signature_len;
+			}
+			tx += signature_len;
 		}
 
-		unsigned char privateKeyData[32];
-		os_perso_derive_node_bip32(CX_CURVE_256R1, bip44_path, BIP44_PATH_LEN, privateKeyData, NULL);
-
-		cx_ecfp_private_key_t privateKey;
-		cx_ecdsa_init_private_key(CX_CURVE_256R1, privateKeyData, 32, &privateKey);
-
-		//hash and sign
-		unsigned char hashResult[SHA256_HASH_LEN];
-		cx_hash(&hash.header, CX_LAST, raw_tx, raw_tx_len_except_bip44, hashResult, sizeof(hashResult));
-
-		tx = cx_ecdsa_sign(&privateKey,  CX_RND_RFC6979 | CX_LAST, CX_SHA256, hashResult, sizeof(hashResult), G_io_apdu_buffer, sizeof(G_io_apdu_buffer), NULL);
-
-		// clear private key data
-		cx_ecdsa_init_private_key(CX_CURVE_256R1, NULL, 0, &privateKey);
-		// memset(&privateKey, 0x00, sizeof(privateKey));
-		memset(privateKeyData, 0x00, sizeof(privateKeyData));
+		// record the signature, with the recipient and value if it is a transfer.
+		tx_summary_t summary;
+		raw_tx_ix = 0;
+		audit_log_add(tx_hash, parse_tx_summary(&summary) ? &summary : NULL);
 
 		hashTainted = 1;
         clear_tx_desc();
@@ -762,7 +759,7 @@ const bagl_element_t*io_seproxyhal_touch_approve(const bagl_element_t *e) {
 		G_io_apdu_buffer[tx++] = 0xFF;
 		G_io_apdu_buffer[tx++] = 0xFF;
 		for (int ix = 0; ix < 32; ix++) {
-			G_io_apdu_buffer[tx++] = hashResult[ix];
+			G_io_apdu_buffer[tx++] = tx_hash[ix];
 		}
 #endif
 
@@ -777,8 +774,122 @@ const bagl_element_t*io_seproxyhal_touch_approve(const bagl_element_t *e) {
 	return 0; // do not redraw the widget
 }
 
+/** approves the batch, its signatures are then requested one by one. */
+static const bagl_element_t *io_seproxyhal_touch_batch_approve(const bagl_element_t *e) {
+	unsigned int tx = 0;
+
+	batch_approve();
+	clear_tx_desc();
+
+	G_io_apdu_buffer[tx++] = batch_tx_count();
+	G_io_apdu_buffer[tx++] = 0x90;
+	G_io_apdu_buffer[tx++] = 0x00;
+	// Send back the response, do not restart the event loop
+	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
+	// Display back the original UX
+	ui_idle();
+	return 0; // do not redraw the widget
+}
+
+/** starts the spending policy, transfers that conform to it are then signed without review. */
+static const bagl_element_t *io_seproxyhal_touch_policy_approve(const bagl_element_t *e) {
+	policy_activate();
+	clear_tx_desc();
+
+	G_io_apdu_buffer[0] = 0x90;
+	G_io_apdu_buffer[1] = 0x00;
+	// Send back the response, do not restart the event loop
+	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+	// Display back the original UX
+	ui_idle();
+	return 0; // do not redraw the widget
+}
+
+/** signs the message, the hash to sign was computed when the last part of the message arrived. */
+static const bagl_element_t *io_seproxyhal_touch_message_approve(const bagl_element_t *e) {
+	unsigned int tx = 0;
+
+	cx_ecfp_private_key_t privateKey;
+	derive_private_key(message_bip44_path(), &privateKey);
+	COUNT_CALL(CALL_COUNT_ECDSA_SIGN);
+	tx = cx_ecdsa_sign(&privateKey, CX_RND_RFC6979 | CX_LAST, CX_SHA256, tx_hash, sizeof(tx_hash), G_io_apdu_buffer, sizeof(G_io_apdu_buffer) - 2, NULL);
+	TRACE(TRACE_SIGN, tx);
+
+	// clear private key data
+	release_private_key(&privateKey);
+
+	message_wipe();
+	clear_tx_desc();
+
+	G_io_apdu_buffer[tx++] = 0x90;
+	G_io_apdu_buffer[tx++] = 0x00;
+	// Send back the response, do not restart the event loop
+	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
+	// Display back the original UX
+	ui_idle();
+	return 0; // do not redraw the widget
+}
+
+/** writes the exit timeout to NVRAM, the timer uses it from the next activity. */
+static const bagl_element_t *io_seproxyhal_touch_exit_timeout_approve(const bagl_element_t *e) {
+	settings_approve_exit_timeout();
+	clear_tx_desc();
+
+	G_io_apdu_buffer[0] = 0x90;
+	G_io_apdu_buffer[1] = 0x00;
+	// Send back the response, do not restart the event loop
+	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+	// Display back the original UX
+	ui_idle();
+	return 0; // do not redraw the widget
+}
+
+/** adds the recipient to the allow-list. */
+static const bagl_element_t *io_seproxyhal_touch_recipient_approve(const bagl_element_t *e) {
+	allow_list_approve();
+	clear_tx_desc();
+
+	G_io_apdu_buffer[0] = 0x90;
+	G_io_apdu_buffer[1] = 0x00;
+	// Send back the response, do not restart the event loop
+	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+	// Display back the original UX
+	ui_idle();
+	return 0; // do not redraw the widget
+}
+
+/** approves what is being reviewed. */
+static const bagl_element_t *io_seproxyhal_touch_review_approve(const bagl_element_t *e) {
+	switch (review_type) {
+	case REVIEW_BATCH:
+		return io_seproxyhal_touch_batch_approve(e);
+	case REVIEW_POLICY:
+		return io_seproxyhal_touch_policy_approve(e);
+	case REVIEW_MESSAGE:
+		return io_seproxyhal_touch_message_approve(e);
+	case REVIEW_RECIPIENT:
+		return io_seproxyhal_touch_recipient_approve(e);
+	case REVIEW_EXIT_TIMEOUT:
+		return io_seproxyhal_touch_exit_timeout_approve(e);
+	default:
+		return io_seproxyhal_touch_approve(e);
+	}
+}
+
 /** deny signing. */
 static const bagl_element_t *io_seproxyhal_touch_deny(const bagl_element_t *e) {
+	signing_key_wipe();
+	if (review_type == REVIEW_BATCH) {
+		batch_reset();
+	} else if (review_type == REVIEW_POLICY) {
+		policy_wipe();
+	} else if (review_type == REVIEW_MESSAGE) {
+		message_wipe();
+	} else if (review_type == REVIEW_RECIPIENT) {
+		allow_list_wipe_request();
+	} else if (review_type == REVIEW_EXIT_TIMEOUT) {
+		settings_wipe_request();
+	}
 	hashTainted = 1;
     clear_tx_desc();
 	raw_tx_ix = 0;
@@ -792,27 +903,85 @@ static const bagl_element_t *io_seproxyhal_touch_deny(const bagl_element_t *e) {
 	return 0; // do not redraw the widget
 }
 
+/** export the public key and chain code of the confirmed account. */
+static const bagl_element_t *io_seproxyhal_touch_export_approve(const bagl_element_t *e) {
+	cx_ecfp_public_key_t publicKey;
+	unsigned int tx = 0;
+
+	// the chain code goes straight into the response, after the public key.
+	derive_node_public_key(export_path, ACCOUNT_PATH_LEN, &publicKey, G_io_apdu_buffer + sizeof(publicKey.W));
+	os_memmove(G_io_apdu_buffer, publicKey.W, sizeof(publicKey.W));
+	tx = sizeof(publicKey.W) + CHAIN_CODE_LEN;
+
+	G_io_apdu_buffer[tx++] = 0x90;
+	G_io_apdu_buffer[tx++] = 0x00;
+	// Send back the response, do not restart the event loop
+	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
+	// Display back the original UX
+	ui_idle();
+	return 0; // do not redraw the widget
+}
+
+/** deny the extended public key export. */
+static const bagl_element_t *io_seproxyhal_touch_export_deny(const bagl_element_t *e) {
+	G_io_apdu_buffer[0] = 0x69;
+	G_io_apdu_buffer[1] = 0x85;
+	// Send back the response, do not restart the event loop
+	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+	// Display back the original UX
+	ui_idle();
+	return 0; // do not redraw the widget
+}
+
+/** during a partial redisplay, skips the elements that did not change, Nano S. */
+static const bagl_element_t * partial_redisplay_preprocessor(const bagl_element_t *element) {
+	if ((redisplay_elements != 0) && ((redisplay_elements & (1 << (element - ux.elements))) == 0)) {
+		return NULL;
+	}
+	return element;
+}
+
+/** sends the elements of the displayed screen in element_mask again, or all of them if it has no preprocessor. */
+static void ui_redisplay_elements(unsigned int element_mask) {
+	redisplay_elements = element_mask;
+	UX_REDISPLAY();
+}
+
 /** show the public key screen */
 void ui_public_key_1(void) {
-	uiState = UI_PUBLIC_KEY_1;
+	set_ui_state(UI_PUBLIC_KEY_1);
+	redisplay_elements = 0;
 	if (os_seph_features() & SEPROXYHAL_TAG_SESSION_START_EVENT_FEATURE_SCREEN_BIG) {
 	} else {
-		UX_DISPLAY(bagl_ui_public_key_nanos_1, NULL);
+		UX_DISPLAY(bagl_ui_public_key_nanos_1, partial_redisplay_preprocessor);
 	}
 }
 
 /** show the public key screen */
 void ui_public_key_2(void) {
-	uiState = UI_PUBLIC_KEY_2;
+	set_ui_state(UI_PUBLIC_KEY_2);
+	redisplay_elements = 0;
 	if (os_seph_features() & SEPROXYHAL_TAG_SESSION_START_EVENT_FEATURE_SCREEN_BIG) {
 	} else {
-		UX_DISPLAY(bagl_ui_public_key_nanos_2, NULL);
+		UX_DISPLAY(bagl_ui_public_key_nanos_2, partial_redisplay_preprocessor);
+	}
+}
+
+/** redisplays the lines of the address, if a public key screen is displayed. */
+void ui_refresh_public_key(void) {
+	if ((uiState == UI_PUBLIC_KEY_1) || (uiState == UI_PUBLIC_KEY_2)) {
+		ui_redisplay_elements(PUBLIC_KEY_LINE_ELEMENTS);
 	}
 }
 
+/** ends a partial redisplay, once its elements were sent. */
+void ui_redisplay_done(void) {
+	redisplay_elements = 0;
+}
+
 /** show the idle screen. */
 void ui_idle(void) {
-	uiState = UI_IDLE;
+	set_ui_state(UI_IDLE);
 
 #if defined(TARGET_NANOS)
     UX_DISPLAY(bagl_ui_idle_nanos, NULL);
@@ -825,61 +994,132 @@ void ui_idle(void) {
 #endif // #if TARGET_ID
 }
 
-/** show the transaction description screen. */
-static void ui_display_tx_desc_single_page(void) {
-	uiState = UI_TX_DESC_SINGLE_PAGE;
+/** sends the elements of the review template that belong to the current screen, with its text, Nano S. */
+static const bagl_element_t * review_preprocessor(const bagl_element_t *element) {
+	static bagl_element_t action_text;
+	const unsigned char userid = element->component.userid;
+	if (userid == REVIEW_ELEMENT_ALL) {
+		return element;
+	}
+	const review_screen_t * screen = REVIEW_SCREEN(uiState);
+	if (screen->text == REVIEW_TEXT_NONE) {
+		return (userid == REVIEW_ELEMENT_DESC) ? element : NULL;
+	}
+	if (userid != REVIEW_ELEMENT_ACTION) {
+		return NULL;
+	}
+	if (element->component.type != BAGL_LABELINE) {
+		return element;
+	}
+	os_memmove(&action_text, element, sizeof(bagl_element_t));
+	action_text.text = REVIEW_TEXTS[review_type][screen->text - REVIEW_TEXT_TOP];
+	return &action_text;
+}
+
+/** show a review screen, on UI_TX_DESC the current page of what is being reviewed. */
+static void ui_display_review(enum UI_STATE state) {
+	if (state == UI_TX_DESC) {
+		load_tx_desc_page(curr_page_ix);
+		if (curr_page_count > 1) {
+			const unsigned int page_number = (curr_page_ix < MAX_PAGE_NUMBER) ? curr_page_ix + 1 : MAX_PAGE_NUMBER;
+			const unsigned int page_count = (curr_page_count < MAX_PAGE_NUMBER) ? curr_page_count : MAX_PAGE_NUMBER;
+			snprintf(curr_page_desc, sizeof(curr_page_desc), "%u/%u", page_number, page_count);
+		} else {
+			curr_page_desc[0] = '\0';
+		}
+	}
+	set_ui_state(state);
 #if defined(TARGET_NANOS)
-    UX_DISPLAY(bagl_ui_tx_desc_nanos_single_page, NULL);
+    UX_DISPLAY(bagl_ui_review_nanos, review_preprocessor);
 #endif // #if TARGET_ID
 }
 
-/** show the transaction description screen. */
-static void ui_display_tx_desc_1(void) {
-	uiState = UI_TX_DESC_1;
+/** show the top of the review, on Nano X the review flow titled "Review" and title. */
+static void ui_top_review(const char * title) {
 #if defined(TARGET_NANOS)
-    UX_DISPLAY(bagl_ui_tx_desc_nanos_1, NULL);
+    ui_display_review(UI_TOP_SIGN);
+#elif defined(TARGET_NANOX)
+    set_ui_state(UI_TOP_SIGN);
+    snprintf(review_title, sizeof(review_title), "%s", title);
+    review_flow_inside = false;
+    // reserve a display stack slot if none yet
+    if(G_ux.stack_count == 0) {
+        ux_stack_push();
+    }
+    ux_flow_init(0, ux_review_flow, NULL);
 #endif // #if TARGET_ID
 }
 
+/** show the top "Sign Transaction" screen. */
+void ui_top_sign(void) {
+	ui_top_review("Transaction");
+}
+
+/** show the top "Sign Batch" screen. */
+void ui_top_sign_batch(void) {
+	ui_top_review("Batch");
+}
 
-/** show the transaction description screen. */
-static void ui_display_tx_desc_2(void) {
-	uiState = UI_TX_DESC_2;
-#if defined(TARGET_NANOS)
-    UX_DISPLAY(bagl_ui_tx_desc_nanos_2, NULL);
-#endif // #if TARGET_ID
+/** show the top "Auto Sign" screen. */
+void ui_top_sign_policy(void) {
+	ui_top_review("Auto Sign");
+}
+
+/** show the top "Sign Message" screen. */
+void ui_top_sign_message(void) {
+	ui_top_review("Message");
 }
 
+/** show the top "Add Recipient" screen. */
+void ui_top_add_recipient(void) {
+	ui_top_review("Recipient");
+}
 
-/** show the bottom "Sign Transaction" screen. */
-static void ui_sign(void) {
-	uiState = UI_SIGN;
-#if defined(TARGET_NANOS)
-    UX_DISPLAY(bagl_ui_sign_nanos, NULL);
-#endif // #if TARGET_ID
+/** show the top "Exit Timeout" screen. */
+void ui_top_set_exit_timeout(void) {
+	ui_top_review("Exit Timeout");
 }
 
-/** show the top "Sign Transaction" screen. */
-void ui_top_sign(void) {
-	uiState = UI_TOP_SIGN;
+/** show the "Export Account Key" screen. */
+void ui_export_public_key(const unsigned int * account_path) {
+	os_memmove(export_path, account_path, sizeof(export_path));
+	snprintf(export_account_desc, sizeof(export_account_desc), "%u", account_path[2] & ~BIP32_HARDENED);
 
+	set_ui_state(UI_EXPORT_PUBLIC_KEY);
 #if defined(TARGET_NANOS)
-    UX_DISPLAY(bagl_ui_top_sign_nanos, NULL);
+    UX_DISPLAY(bagl_ui_export_public_key_nanos, NULL);
 #elif defined(TARGET_NANOX)
     // reserve a display stack slot if none yet
     if(G_ux.stack_count == 0) {
         ux_stack_push();
     }
-    ux_flow_init(0, ux_confirm_single_flow, NULL);
+    ux_flow_init(0, ux_export_public_key_flow, NULL);
 #endif // #if TARGET_ID
 }
 
-/** show the "deny" screen */
-static void ui_deny(void) {
-	uiState = UI_DENY;
-#if defined(TARGET_NANOS)
-    UX_DISPLAY(bagl_ui_deny_nanos, NULL);
-#endif // #if TARGET_ID
+/** forgets the signatures, keys, batch, spending policy and message kept for the session, and writes the audit records still in RAM. */
+void wipe_session(void) {
+	// the session ends, the records still in RAM are written, whether they fill a page or not.
+	audit_log_flush();
+	signature_cache_wipe();
+	batch_reset();
+	policy_wipe();
+	message_wipe();
+	session_keys_wipe();
+	scratch_reset();
+}
+
+/** returns true while the transaction review screens are displayed. */
+bool is_reviewing_tx(void) {
+	switch (uiState) {
+	case UI_TOP_SIGN:
+	case UI_TX_DESC:
+	case UI_SIGN:
+	case UI_DENY:
+		return true;
+	default:
+		return false;
+	}
 }
 
 /** returns the length of the transaction in the buffer. */
@@ -890,11 +1130,5 @@ unsigned int get_apdu_buffer_length() {
 
 /** sets the tx_desc variables to no information */
 static void clear_tx_desc(void) {
-    for(uint8_t i=0; i<MAX_TX_TEXT_SCREENS; i++) {
-        for(uint8_t j=0; j<MAX_TX_TEXT_LINES; j++) {
-            tx_desc[i][j][0] = '\0';
-            tx_desc[i][j][MAX_TX_TEXT_WIDTH - 1] = '\0';
-        }
-    }
+	os_memset(curr_tx_desc, '\0', CURR_TX_DESC_LEN);
 }
-
@@ -12,11 +12,11 @@
 #include "sha256_hash_len.h"
 
 
-/** the timer */
-extern int exit_timer;
+/** the timer, the seconds left before the app exits */
+extern unsigned int exit_timer;
 
-/** max with of timer display */
-#define MAX_TIMER_TEXT_WIDTH 4
+/** max with of timer display, up to MAX_EXIT_TIMEOUT seconds */
+#define MAX_TIMER_TEXT_WIDTH 5
 
 /** display for the timer */
 extern char timer_desc[MAX_TIMER_TEXT_WIDTH];
@@ -33,16 +33,31 @@ extern char timer_desc[MAX_TIMER_TEXT_WIDTH];
 /** for signing, indicates this is not the last part of the transaction, there are more parts coming. */
 #define P1_MORE 0x00
 
+/** for signing, indicates the transaction is followed by a single BIP44 path. */
+#define P2_SINGLE_PATH 0x00
+
+/** for signing, indicates the transaction is followed by a list of BIP44 paths and their count, instead of a single path. */
+#define P2_MULTI_PATH 0x01
+
+/** max number of BIP44 paths to sign one transaction with, a length byte and a signature for each must fit in the response. */
+#define MAX_SIGN_PATHS 3
+
 /** length of BIP44 path */
 #define BIP44_PATH_LEN 5
 
 /** length of BIP44 path, in bytes */
 #define  BIP44_BYTE_LENGTH (BIP44_PATH_LEN * sizeof(unsigned int))
 
+/** length of an account level path, m/44'/888'/account' */
+#define ACCOUNT_PATH_LEN 3
+
+/** length of an account level path, in bytes */
+#define ACCOUNT_PATH_BYTE_LENGTH (ACCOUNT_PATH_LEN * sizeof(unsigned int))
+
 /**
  * Nano S has 320 KB flash, 10 KB RAM, uses a ST31H320 chip.
  * This effectively limits the max size
- * So we can only display 9 screens of data, and can only sign transactions up to 1kb in size.
+ * So we can only sign transactions up to 1kb in size.
  * max size of a transaction, binary will not compile if we try to allow transactions over 1kb.
  */
 #define MAX_TX_RAW_LENGTH 800
@@ -53,31 +68,36 @@ extern char timer_desc[MAX_TIMER_TEXT_WIDTH];
 /** max lines of text to display. */
 #define MAX_TX_TEXT_LINES 3
 
-/** max number of screens to display. */
-#define MAX_TX_TEXT_SCREENS 9
+#if defined(TARGET_NANOX)
+/** lines of text on a step of the review flow, Nano X, the label as the title then up to three lines of the value. */
+#define TX_DESC_PAGE_LINES (1 + MAX_TX_TEXT_LINES)
+#else // TARGET_NANOX
+/** lines of text on a page of the review screens, Nano S. each page starts one line further than the previous one. */
+#define TX_DESC_PAGE_LINES 2
+#endif // TARGET_NANOX
 
 /** max number of hex bytes that can be displayed (2 hex characters for 1 byte of data) */
 #define MAX_HEX_BUFFER_LEN (MAX_TX_TEXT_WIDTH / 2)
 
 /** max number of bytes for one line of text. */
-#define CURR_TX_DESC_LEN (MAX_TX_TEXT_LINES * MAX_TX_TEXT_WIDTH)
-
-/** max number of bytes for all text screens. */
-#define MAX_TX_DESC_LEN (MAX_TX_TEXT_SCREENS * CURR_TX_DESC_LEN)
+#define CURR_TX_DESC_LEN (TX_DESC_PAGE_LINES * MAX_TX_TEXT_WIDTH)
 
 /** UI currently displayed */
 enum UI_STATE {
-	UI_INIT, UI_IDLE, UI_TOP_SIGN, UI_TX_DESC_1, UI_TX_DESC_2, UI_TX_DESC_SINGLE_PAGE, UI_SIGN, UI_DENY, UI_PUBLIC_KEY_1, UI_PUBLIC_KEY_2
+	UI_INIT, UI_IDLE, UI_TOP_SIGN, UI_TX_DESC, UI_SIGN, UI_DENY, UI_PUBLIC_KEY_1, UI_PUBLIC_KEY_2, UI_EXPORT_PUBLIC_KEY
 };
 
-/** use single or two page screen */
-enum SCREEN_TYPE {
-	SINGLE_PAGE = 0x00, TWO_PAGE = 0x01
+/** what the review screens are for */
+enum REVIEW_TYPE {
+	REVIEW_TX, REVIEW_BATCH, REVIEW_POLICY, REVIEW_MESSAGE, REVIEW_RECIPIENT, REVIEW_EXIT_TIMEOUT
 };
 
 /** UI state enum */
 extern enum UI_STATE uiState;
 
+/** review type enum */
+extern enum REVIEW_TYPE review_type;
+
 /** UI state flag */
 extern ux_state_t ux;
 
@@ -90,6 +110,9 @@ extern unsigned char publicKeyNeedsRefresh;
 /** the hash. */
 extern cx_sha256_t hash;
 
+/** the hash result of the transaction being signed. */
+extern unsigned char tx_hash[SHA256_HASH_LEN];
+
 /** index of the current screen. */
 extern unsigned int curr_scr_ix;
 
@@ -105,17 +128,18 @@ extern unsigned int raw_tx_ix;
 /** current length of raw transaction. */
 extern unsigned int raw_tx_len;
 
-/** all text descriptions. */
-extern char tx_desc[MAX_TX_TEXT_SCREENS][MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
+/** length of the transaction in raw_tx, without the trailing BIP44 paths. */
+extern unsigned int raw_tx_body_len;
+
+/** number of BIP44 paths to sign the transaction with. */
+extern unsigned char sign_path_count;
 
 /** currently displayed text description. */
-extern char curr_tx_desc[MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
+extern char curr_tx_desc[TX_DESC_PAGE_LINES][MAX_TX_TEXT_WIDTH];
 
 /** currently displayed public key */
 extern char current_public_key[MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
 
-extern int screen_index_page_type[MAX_TX_TEXT_SCREENS];
-
 /** process a partial transaction */
 const bagl_element_t * io_seproxyhal_touch_approve(const bagl_element_t *e);
 
@@ -125,6 +149,36 @@ void ui_idle(void);
 /** show the "Sign TX" ui, starting at the top of the Tx display */
 void ui_top_sign(void);
 
+/** show the "Sign Batch" ui, starting at the top of the batch summary */
+void ui_top_sign_batch(void);
+
+/** show the "Auto Sign" ui, starting at the top of the spending policy */
+void ui_top_sign_policy(void);
+
+/** show the "Sign Message" ui, starting at the top of the message description */
+void ui_top_sign_message(void);
+
+/** show the "Add Recipient" ui, starting at the top of the recipient to add to the allow-list */
+void ui_top_add_recipient(void);
+
+/** show the "Exit Timeout" ui, starting at the top of the current and new exit timeouts */
+void ui_top_set_exit_timeout(void);
+
+/** show the "Export Account Key" ui, for the given account level path */
+void ui_export_public_key(const unsigned int * account_path);
+
+/** redisplays only the lines of the address, if a public key screen is displayed */
+void ui_refresh_public_key(void);
+
+/** ends a partial redisplay, called once all of its elements were sent */
+void ui_redisplay_done(void);
+
+/** returns true while the transaction review screens are displayed */
+bool is_reviewing_tx(void);
+
+/** forget the signatures and keys kept for the session, before exiting */
+void wipe_session(void);
+
 /** return the length of the communication buffer */
 unsigned int get_apdu_buffer_length();
 
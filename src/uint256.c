@@ -21,6 +21,7 @@
 #include <stdlib.h>
 
 #include "uint256.h"
+#include "call_counts.h"
 
 static const char HEXDIGITS[] = "0123456789abcdef";
 
@@ -453,6 +454,7 @@ void divmod128(uint128_t *l, uint128_t *r, uint128_t *retDiv,
 
 void divmod256(uint256_t *l, uint256_t *r, uint256_t *retDiv,
                uint256_t *retMod) {
+    COUNT_CALL(CALL_COUNT_DIVMOD256);
     uint256_t copyd, adder, resDiv, resMod;
     uint256_t one;
     clear256(&one);
@@ -508,7 +510,8 @@ bool tostring128(uint128_t *number, uint32_t baseParam, char *out,
         return false;
     }
     do {
-        if (offset > (outLength - 1)) {
+        // keep room for the terminating zero.
+        if (offset >= (outLength - 1)) {
             return false;
         }
         divmod128(&rDiv, &base, &rDiv, &rMod);
@@ -519,26 +522,37 @@ bool tostring128(uint128_t *number, uint32_t baseParam, char *out,
     return true;
 }
 
+/** divides number by a divisor of at most 16 bits, in place, and returns the remainder. */
+static uint32_t divmod256_small(uint256_t *number, uint32_t divisor) {
+    COUNT_CALL(CALL_COUNT_DIVMOD256_SMALL);
+    uint64_t remainder = 0;
+    // long division over the 32 bit halves of each 64 bit element, most significant first.
+    for (uint32_t i = 0; i < 4; i++) {
+        uint64_t *element = &number->elements[i / 2].elements[i % 2];
+        uint64_t high = (remainder << 32) | (*element >> 32);
+        remainder = high % divisor;
+        uint64_t low = (remainder << 32) | (*element & 0xFFFFFFFF);
+        remainder = low % divisor;
+        *element = ((high / divisor) << 32) | (low / divisor);
+    }
+    return (uint32_t) remainder;
+}
+
 bool tostring256(uint256_t *number, uint32_t baseParam, char *out,
                  uint32_t outLength) {
+    COUNT_CALL(CALL_COUNT_TOSTRING256);
     uint256_t rDiv;
-    uint256_t rMod;
-    uint256_t base;
     copy256(&rDiv, number);
-    clear256(&rMod);
-    clear256(&base);
-    UPPER(LOWER(base)) = 0;
-    LOWER(LOWER(base)) = baseParam;
     uint32_t offset = 0;
     if ((baseParam < 2) || (baseParam > 16)) {
         return false;
     }
     do {
-        if (offset > (outLength - 1)) {
+        // keep room for the terminating zero.
+        if (offset >= (outLength - 1)) {
             return false;
         }
-        divmod256(&rDiv, &base, &rDiv, &rMod);
-        out[offset++] = HEXDIGITS[(uint8_t)LOWER(LOWER(rMod))];
+        out[offset++] = HEXDIGITS[divmod256_small(&rDiv, baseParam)];
     } while (!zero256(&rDiv));
     out[offset] = '\0';
     reverseString(out, offset);
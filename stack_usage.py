@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+Worst case stack depth of the app, from the disassembly of the linked ELF.
+
+clang 7 has no -fstack-usage, so the frame of each function is read from its
+prologue (push, vpush and sub sp) and the call graph from its direct calls
+(bl, blx and tail call branches to another function). A call through a
+pointer, such as a button handler or an element preprocessor, is counted as a
+call to the deepest function that is never called directly.
+
+Writes the frame and the worst case depth of each function to the report,
+and exits with an error if the depth from main is over the budget, a budget
+of 0 only writes the report. A budget of "linker" is the size of the stack
+the linker script of the SDK reserves, from _stack to _estack in the ELF. Functions that change sp by a register (a VLA,
+alloca or a large frame) or recurse have no bound, they are warned about and
+counted with the part of their frame that is known.
+
+usage: stack_usage.py <objdump> <elf> <budget> [<report>]
+"""
+
+import re
+import subprocess
+import sys
+
+FUNCTION = re.compile(r'^([0-9a-f]+) <([^>]+)>:$')
+REGISTERS = re.compile(r'\{([^}]*)\}')
+IMMEDIATE = re.compile(r'#(\d+)')
+TARGET = re.compile(r'<([^>+]+)>')
+# address, encoding, then the mnemonic and the operands after tabs, as printed by GNU and LLVM objdump.
+INSTRUCTION = re.compile(r'^\s*[0-9a-f]+:\s*[0-9a-f ]+\t([^\t]+)(?:\t(.*))?$')
+
+# registers in a push or vpush, r4-r7 counts as 4.
+def register_count(operands):
+	count = 0
+	for register in REGISTERS.search(operands).group(1).split(','):
+		bounds = re.findall(r'\d+', register)
+		if '-' in register and len(bounds) == 2:
+			count += int(bounds[1]) - int(bounds[0]) + 1
+		else:
+			count += 1
+	return count
+
+
+def parse(objdump, elf):
+	disassembly = subprocess.run([objdump, '-d', elf], check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+	frames = {}
+	calls = {}
+	indirect = set()
+	dynamic = set()
+	name = None
+	for line in disassembly.splitlines():
+		match = FUNCTION.match(line)
+		if match:
+			name = match.group(2)
+			frames[name] = 0
+			calls[name] = set()
+			continue
+		match = INSTRUCTION.match(line)
+		if name is None or not match:
+			continue
+		# comments start with @ or ;, and the .w or .n width suffix doesn't matter.
+		mnemonic = match.group(1).strip().split('.')[0]
+		operands = re.split('[@;]', match.group(2) or '')[0].strip()
+		if mnemonic == 'push':
+			frames[name] += 4 * register_count(operands)
+		elif mnemonic == 'vpush':
+			frames[name] += 8 * register_count(operands)
+		elif re.match(r'^sp, (sp, )?#\d+$', operands) and mnemonic == 'sub':
+			frames[name] += int(IMMEDIATE.search(operands).group(1))
+		elif re.match(r'^sp, (sp, )?r\d+$', operands) and mnemonic in ('sub', 'add'):
+			# large frames and VLAs move sp by a register, the size isn't known from the code.
+			dynamic.add(name)
+		elif mnemonic in ('bl', 'blx', 'b'):
+			target = TARGET.search(operands)
+			if target:
+				if target.group(1) != name:
+					calls[name].add(target.group(1))
+			elif mnemonic == 'blx':
+				indirect.add(name)
+	return frames, calls, indirect, dynamic
+
+
+# bytes between _stack and _estack, the stack reserved by the linker script.
+def linker_stack_size(objdump, elf):
+	symbols = subprocess.run([objdump, '-t', elf], check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+	addresses = {}
+	for line in symbols.splitlines():
+		fields = line.split()
+		if fields and fields[-1] in ('_stack', '_estack'):
+			addresses[fields[-1]] = int(fields[0], 16)
+	if len(addresses) != 2:
+		sys.exit('stack_usage.py: no _stack and _estack in ' + elf)
+	return addresses['_estack'] - addresses['_stack']
+
+
+def depths(frames, calls, indirect):
+	called = set(callee for callees in calls.values() for callee in callees)
+	pointer_targets = [function for function in frames if function not in called and function != 'main']
+	depth = {}
+	recursive = set()
+
+	def visit(function, path):
+		if function in depth:
+			return depth[function]
+		if function in path:
+			recursive.add(function)
+			return 0
+		path.add(function)
+		deepest = 0
+		for callee in calls.get(function, ()):
+			deepest = max(deepest, visit(callee, path))
+		if function in indirect:
+			for target in pointer_targets:
+				if target not in path:
+					deepest = max(deepest, visit(target, path))
+		path.remove(function)
+		depth[function] = frames.get(function, 0) + deepest
+		return depth[function]
+
+	for function in frames:
+		visit(function, set())
+	return depth, recursive
+
+
+def main():
+	if len(sys.argv) < 4:
+		sys.exit(__doc__)
+	objdump, elf = sys.argv[1], sys.argv[2]
+	budget = linker_stack_size(objdump, elf) if sys.argv[3] == 'linker' else int(sys.argv[3])
+	frames, calls, indirect, dynamic = parse(objdump, elf)
+	depth, recursive = depths(frames, calls, indirect)
+
+	lines = ['%6s %6s  %s' % ('frame', 'depth', 'function')]
+	for function in sorted(frames, key=lambda function: -depth[function]):
+		lines.append('%6d %6d  %s' % (frames[function], depth[function], function))
+	report = '\n'.join(lines) + '\n'
+	if len(sys.argv) > 4:
+		with open(sys.argv[4], 'w') as out:
+			out.write(report)
+	else:
+		sys.stdout.write(report)
+
+	for function in sorted(dynamic):
+		sys.stderr.write('stack_usage.py: warning: %s changes sp by a register, its frame has no bound\n' % function)
+	for function in sorted(recursive):
+		sys.stderr.write('stack_usage.py: warning: %s is recursive, its depth has no bound\n' % function)
+	if 'main' not in depth:
+		sys.exit('stack_usage.py: no main in ' + elf)
+	if budget and (depth['main'] > budget):
+		sys.exit('stack_usage.py: stack depth from main is %d bytes, over the budget of %d bytes' % (depth['main'], budget))
+	if budget:
+		print('stack depth from main: %d of %d bytes' % (depth['main'], budget))
+	else:
+		print('stack depth from main: %d bytes, no budget set' % depth['main'])
+
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,53 @@
+# The app core built for Linux, included by the Makefile for make host, instead of the rules of the SDK.
+#
+# Builds cpx.c, uint256.c, the APDU dispatch of main.c and the code they call into bin/host/libcpx.a, for the Nano S,
+# against the headers of stub/include and the system calls of stub/host. These run on OpenSSL (libcrypto), and derive
+# the keys from the test mnemonic of the README. bin/host/cpx_replay runs the app on a script of APDUs and button
+# pushes, to profile it with perf or run it under a sanitizer at native speed:
+#
+#   make host HOST_CFLAGS="-O1 -g -fno-omit-frame-pointer -fsanitize=address,undefined"
+#   perf record -g bin/host/cpx_replay -n 1000 stub/host/sign.txt
+
+HOST_CC = cc
+HOST_CFLAGS = -O2 -g
+HOST_LDLIBS = -lcrypto
+
+# the same opt-in flags as the device build.
+SESSION_KEY_CACHE = 0
+CALL_COUNTS = 0
+DEBUG = 0
+
+HOST_DEFINES = HOST_BUILD TARGET_NANOS APPVERSION=\"0.0.2\" IO_SEPROXYHAL_BUFFER_SIZE_B=128 PRINTF\(...\)=
+ifneq ($(SESSION_KEY_CACHE),0)
+HOST_DEFINES += HAVE_SESSION_KEY_CACHE
+endif
+ifneq ($(CALL_COUNTS),0)
+HOST_DEFINES += HAVE_CALL_COUNTS
+endif
+ifneq ($(DEBUG),0)
+HOST_DEFINES += HAVE_TRACE
+endif
+
+# the stack of the host is not the one of the device, stack_usage.c is replaced by stub/host/os.c.
+HOST_SOURCES = $(filter-out src/stack_usage.c,$(wildcard src/*.c)) stub/host/os.c stub/host/cx.c stub/host/seed.c
+HOST_OBJECTS = $(patsubst %.c,bin/host/obj/%.o,$(HOST_SOURCES))
+
+HOST_ALL_CFLAGS = -std=gnu99 -Wall -Istub/include -Isrc $(addprefix -D,$(HOST_DEFINES)) $(HOST_CFLAGS)
+
+.PHONY: host host_clean
+
+host: bin/host/libcpx.a bin/host/cpx_replay
+
+bin/host/obj/%.o: %.c $(wildcard src/*.h stub/include/*.h)
+	@mkdir -p $(dir $@)
+	$(HOST_CC) -c $(HOST_ALL_CFLAGS) -o $@ $<
+
+bin/host/libcpx.a: $(HOST_OBJECTS)
+	rm -f $@
+	$(AR) rcs $@ $^
+
+bin/host/cpx_replay: bin/host/obj/stub/host/replay.o bin/host/libcpx.a
+	$(HOST_CC) $(HOST_CFLAGS) -o $@ $^ $(HOST_LDLIBS)
+
+host_clean:
+	rm -rf bin/host
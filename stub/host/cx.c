@@ -0,0 +1,292 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+/** the crypto system calls of the SDK, for the host build, make host, on OpenSSL. */
+
+#include "cx.h"
+
+#include <stdlib.h>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/obj_mac.h>
+
+/** max number of hashes in progress at once, the app has at most two. */
+#define MAX_HASHES 8
+
+/** flag of info in cx_ecdsa_sign, y of the point kG is odd. */
+#define CX_ECCINFO_PARITY_ODD 1
+
+/** the OpenSSL context of a hash in progress, by the address of its context in the app. */
+typedef struct {
+	const cx_hash_t * hash;
+	EVP_MD_CTX * ctx;
+} hash_slot_t;
+
+/** the hashes in progress, a new one takes the place of the oldest once all slots are used. */
+static hash_slot_t hashes[MAX_HASHES];
+
+/** the slot the next new hash takes. */
+static unsigned int next_hash_slot;
+
+/** P-256, the curve of all the keys of the app. */
+static EC_GROUP * curve;
+
+/** scratch numbers of the OpenSSL calls. */
+static BN_CTX * bn_ctx;
+
+/** aborts on a failed OpenSSL call, they only fail on bad arguments or no memory. */
+static void check(int ok) {
+	if (!ok) {
+		fprintf(stderr, "OpenSSL call failed\n");
+		abort();
+	}
+}
+
+static void init_curve(void) {
+	if (curve == NULL) {
+		curve = EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1);
+		bn_ctx = BN_CTX_new();
+		check((curve != NULL) && (bn_ctx != NULL));
+	}
+}
+
+/** returns the OpenSSL context of the hash, a new one on init. */
+static EVP_MD_CTX * hash_ctx(const cx_hash_t * hash, int init) {
+	for (unsigned int ix = 0; ix < MAX_HASHES; ix++) {
+		if (hashes[ix].hash == hash) {
+			return hashes[ix].ctx;
+		}
+	}
+	if (!init) {
+		fprintf(stderr, "cx_hash on a context that was not initialized\n");
+		abort();
+	}
+	hash_slot_t * slot = &hashes[next_hash_slot];
+	next_hash_slot = (next_hash_slot + 1) % MAX_HASHES;
+	if (slot->ctx == NULL) {
+		slot->ctx = EVP_MD_CTX_new();
+		check(slot->ctx != NULL);
+	}
+	slot->hash = hash;
+	return slot->ctx;
+}
+
+int cx_sha256_init(cx_sha256_t * hash) {
+	os_memset(hash, 0, sizeof(cx_sha256_t));
+	check(EVP_DigestInit_ex(hash_ctx(&hash->header, 1), EVP_sha256(), NULL));
+	return 0;
+}
+
+int cx_ripemd160_init(cx_ripemd160_t * hash) {
+	os_memset(hash, 0, sizeof(cx_ripemd160_t));
+	check(EVP_DigestInit_ex(hash_ctx(&hash->header, 1), EVP_ripemd160(), NULL));
+	return 0;
+}
+
+int cx_hash(cx_hash_t * hash, int mode, const unsigned char * in, unsigned int len, unsigned char * out, unsigned int out_len) {
+	EVP_MD_CTX * ctx = hash_ctx(hash, 0);
+	check(EVP_DigestUpdate(ctx, in, len));
+	hash->counter += len;
+	if ((mode & CX_LAST) == 0) {
+		return 0;
+	}
+	unsigned int digest_len = EVP_MD_CTX_get_size(ctx);
+	if (digest_len > out_len) {
+		THROW(INVALID_PARAMETER);
+	}
+	// as on the device, the context starts over once the hash is written.
+	check(EVP_DigestFinal_ex(ctx, out, &digest_len));
+	check(EVP_DigestInit_ex(ctx, NULL, NULL));
+	hash->counter = 0;
+	return digest_len;
+}
+
+int cx_hmac_sha512(const unsigned char * key, unsigned int key_len, const unsigned char * in, unsigned int len, unsigned char * mac, unsigned int mac_len) {
+	unsigned char result[64];
+	unsigned int result_len = sizeof(result);
+	check(HMAC(EVP_sha512(), key, key_len, in, len, result, &result_len) != NULL);
+	if (mac_len > result_len) {
+		mac_len = result_len;
+	}
+	os_memmove(mac, result, mac_len);
+	return mac_len;
+}
+
+int cx_ecdsa_init_private_key(int curve_id, const unsigned char * raw_key, unsigned int key_len, cx_ecfp_private_key_t * private_key) {
+	os_memset(private_key, 0, sizeof(cx_ecfp_private_key_t));
+	private_key->curve = curve_id;
+	if (raw_key != NULL) {
+		if (key_len != sizeof(private_key->d)) {
+			THROW(INVALID_PARAMETER);
+		}
+		os_memmove(private_key->d, raw_key, key_len);
+		private_key->d_len = key_len;
+	}
+	return private_key->d_len;
+}
+
+int cx_ecdsa_init_public_key(int curve_id, const unsigned char * raw_key, unsigned int key_len, cx_ecfp_public_key_t * public_key) {
+	os_memset(public_key, 0, sizeof(cx_ecfp_public_key_t));
+	public_key->curve = curve_id;
+	if (raw_key != NULL) {
+		if (key_len != sizeof(public_key->W)) {
+			THROW(INVALID_PARAMETER);
+		}
+		os_memmove(public_key->W, raw_key, key_len);
+		public_key->W_len = key_len;
+	}
+	return public_key->W_len;
+}
+
+int cx_ecfp_generate_pair(int curve_id, cx_ecfp_public_key_t * public_key, cx_ecfp_private_key_t * private_key, int keep_private) {
+	if (!keep_private || (private_key->d_len != sizeof(private_key->d))) {
+		// the app only ever derives the public key of a private key it has.
+		THROW(INVALID_PARAMETER);
+	}
+	init_curve();
+	BIGNUM * d = BN_bin2bn(private_key->d, sizeof(private_key->d), NULL);
+	EC_POINT * w = EC_POINT_new(curve);
+	check((d != NULL) && (w != NULL));
+	check(EC_POINT_mul(curve, w, d, NULL, NULL, bn_ctx));
+	public_key->curve = curve_id;
+	public_key->W_len = EC_POINT_point2oct(curve, w, POINT_CONVERSION_UNCOMPRESSED, public_key->W, sizeof(public_key->W), bn_ctx);
+	check(public_key->W_len == sizeof(public_key->W));
+	EC_POINT_free(w);
+	BN_clear_free(d);
+	return 0;
+}
+
+/** HMAC-SHA256 of the parts of data, for the nonce of RFC 6979. */
+static void hmac_sha256(const unsigned char * key, const unsigned char * data, size_t data_len, unsigned char * mac) {
+	unsigned int mac_len = 32;
+	check(HMAC(EVP_sha256(), key, 32, data, data_len, mac, &mac_len) != NULL);
+}
+
+/** derives the nonce k from the private key and the hash, as in RFC 6979 section 3.2, with HMAC-SHA256, on a 256 bit order. */
+static void rfc6979_nonce(const BIGNUM * order, const unsigned char * d, const unsigned char * hash, BIGNUM * k) {
+	unsigned char v[32];
+	unsigned char key[32];
+	// V || 0x00 or 0x01 || int2octets(d) || bits2octets(hash).
+	unsigned char data[32 + 1 + 32 + 32];
+	unsigned char h1[32];
+
+	BIGNUM * h = BN_bin2bn(hash, 32, NULL);
+	check(h != NULL);
+	if (BN_cmp(h, order) >= 0) {
+		check(BN_sub(h, h, order));
+	}
+	check(BN_bn2binpad(h, h1, sizeof(h1)) == sizeof(h1));
+	BN_free(h);
+
+	os_memset(v, 0x01, sizeof(v));
+	os_memset(key, 0x00, sizeof(key));
+	for (unsigned char round = 0; round < 2; round++) {
+		os_memmove(data, v, 32);
+		data[32] = round;
+		os_memmove(data + 33, d, 32);
+		os_memmove(data + 65, h1, 32);
+		hmac_sha256(key, data, sizeof(data), key);
+		hmac_sha256(key, v, sizeof(v), v);
+	}
+	for (;;) {
+		hmac_sha256(key, v, sizeof(v), v);
+		check(BN_bin2bn(v, sizeof(v), k) != NULL);
+		if (!BN_is_zero(k) && (BN_cmp(k, order) < 0)) {
+			break;
+		}
+		os_memmove(data, v, 32);
+		data[32] = 0x00;
+		hmac_sha256(key, data, 33, key);
+		hmac_sha256(key, v, sizeof(v), v);
+	}
+	OPENSSL_cleanse(key, sizeof(key));
+	OPENSSL_cleanse(data, sizeof(data));
+}
+
+int cx_ecdsa_sign(const cx_ecfp_private_key_t * private_key, int mode, int hash_id, const unsigned char * hash, unsigned int hash_len,
+		unsigned char * sig, unsigned int sig_len, unsigned int * info) {
+	if (((mode & CX_RND_RFC6979) != CX_RND_RFC6979) || (hash_id != CX_SHA256) || (hash_len != 32)
+			|| (private_key->d_len != sizeof(private_key->d))) {
+		THROW(INVALID_PARAMETER);
+	}
+	init_curve();
+	const BIGNUM * order = EC_GROUP_get0_order(curve);
+	BIGNUM * d = BN_bin2bn(private_key->d, sizeof(private_key->d), NULL);
+	BIGNUM * e = BN_bin2bn(hash, hash_len, NULL);
+	BIGNUM * k = BN_new();
+	BIGNUM * x = BN_new();
+	BIGNUM * y = BN_new();
+	BIGNUM * r = BN_new();
+	BIGNUM * s = BN_new();
+	EC_POINT * point = EC_POINT_new(curve);
+	check((d != NULL) && (e != NULL) && (k != NULL) && (x != NULL) && (y != NULL) && (r != NULL) && (s != NULL) && (point != NULL));
+
+	// r = x(kG) mod n, s = k^-1 (e + r d) mod n.
+	rfc6979_nonce(order, private_key->d, hash, k);
+	check(EC_POINT_mul(curve, point, k, NULL, NULL, bn_ctx));
+	check(EC_POINT_get_affine_coordinates(curve, point, x, y, bn_ctx));
+	check(BN_nnmod(r, x, order, bn_ctx));
+	check(BN_mod_mul(s, r, d, order, bn_ctx));
+	check(BN_mod_add(s, s, e, order, bn_ctx));
+	check(BN_mod_inverse(k, k, order, bn_ctx) != NULL);
+	check(BN_mod_mul(s, s, k, order, bn_ctx));
+	unsigned int parity = BN_is_odd(y) ? CX_ECCINFO_PARITY_ODD : 0;
+	// the device sends the low s, n - s if s is over n / 2, which is the signature of -kG, of the other parity.
+	check(BN_rshift1(x, order));
+	if (BN_cmp(s, x) > 0) {
+		check(BN_sub(s, order, s));
+		parity ^= CX_ECCINFO_PARITY_ODD;
+	}
+	if (info != NULL) {
+		*info = parity;
+	}
+
+	// the signature is DER encoded, as the device sends it.
+	ECDSA_SIG * der = ECDSA_SIG_new();
+	check(der != NULL);
+	check(ECDSA_SIG_set0(der, r, s));
+	const int len = i2d_ECDSA_SIG(der, NULL);
+	if ((len <= 0) || ((unsigned int) len > sig_len)) {
+		THROW(INVALID_PARAMETER);
+	}
+	unsigned char * out = sig;
+	check(i2d_ECDSA_SIG(der, &out) == len);
+
+	ECDSA_SIG_free(der);
+	EC_POINT_free(point);
+	BN_free(y);
+	BN_free(x);
+	BN_clear_free(k);
+	BN_free(e);
+	BN_clear_free(d);
+	return len;
+}
+
+void cx_math_addm(unsigned char * r, const unsigned char * a, const unsigned char * b, const unsigned char * m, unsigned int len) {
+	init_curve();
+	BIGNUM * bn_a = BN_bin2bn(a, len, NULL);
+	BIGNUM * bn_b = BN_bin2bn(b, len, NULL);
+	BIGNUM * bn_m = BN_bin2bn(m, len, NULL);
+	check((bn_a != NULL) && (bn_b != NULL) && (bn_m != NULL));
+	check(BN_mod_add(bn_a, bn_a, bn_b, bn_m, bn_ctx));
+	check(BN_bn2binpad(bn_a, r, len) == (int) len);
+	BN_clear_free(bn_m);
+	BN_clear_free(bn_b);
+	BN_clear_free(bn_a);
+}
+
+int cx_math_cmp(const unsigned char * a, const unsigned char * b, unsigned int len) {
+	return memcmp(a, b, len);
+}
+
+int cx_math_is_zero(const unsigned char * a, unsigned int len) {
+	for (unsigned int ix = 0; ix < len; ix++) {
+		if (a[ix] != 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
@@ -0,0 +1,110 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+/** the system calls of the OS and the io of the SDK, for the host build, make host. */
+
+#include "os.h"
+#include "os_io_seproxyhal.h"
+#include "stack_usage.h"
+#include "host.h"
+
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/** the buffer of the APDU being handled, and of its response. */
+unsigned char G_io_apdu_buffer[260];
+
+/** the innermost open TRY. */
+static try_context_t * try_context;
+
+/** length of the response sent by io_exchange with IO_RETURN_AFTER_TX, not yet read by host_reply. */
+static unsigned int reply_len;
+
+try_context_t * try_context_get(void) {
+	return try_context;
+}
+
+try_context_t * try_context_set(try_context_t * context) {
+	try_context_t * previous = try_context;
+	try_context = context;
+	return previous;
+}
+
+void os_longjmp(unsigned int exception) {
+	if (try_context == NULL) {
+		fprintf(stderr, "exception %04X raised outside of a TRY\n", exception);
+		abort();
+	}
+	longjmp(try_context->jmp_buf, exception);
+}
+
+/** the NVRAM variables are const, so the compiler puts them in read only pages, which are only made writable here. */
+void nvm_write(void * dst, void * src, unsigned int len) {
+	const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+	const uintptr_t start = ((uintptr_t) dst) & ~(page_size - 1);
+	const size_t size = (((uintptr_t) dst) + len) - start;
+	if (mprotect((void *) start, size, PROT_READ | PROT_WRITE) != 0) {
+		perror("nvm_write");
+		abort();
+	}
+	memmove(dst, src, len);
+	mprotect((void *) start, size, PROT_READ);
+}
+
+void os_sched_exit(unsigned int exit_code) {
+	fprintf(stderr, "the app exited to the dashboard\n");
+	exit(exit_code);
+}
+
+/** the host build is a Nano S, with a 128x32 screen. */
+unsigned int os_seph_features(void) {
+	return 0;
+}
+
+void reset(void) {
+	abort();
+}
+
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len) {
+	// the APDU are handed to host_apdu, only the responses sent once the user approves or denies come here.
+	if ((channel_and_flags & IO_RETURN_AFTER_TX) == 0) {
+		THROW(INVALID_PARAMETER);
+	}
+	reply_len = tx_len;
+	return 0;
+}
+
+unsigned int host_reply(void) {
+	const unsigned int len = reply_len;
+	reply_len = 0;
+	return len;
+}
+
+/** the stack of the host is not the one of the device, its size and usage are reported as 0. */
+unsigned int stack_usage_read(unsigned char * out) {
+	os_memset(out, 0, 12);
+	return 12;
+}
+
+/** there is no screen, the elements are only built by the preprocessors of ui.c. */
+void io_seproxyhal_display_default(bagl_element_t * element) {
+}
+
+void io_seproxyhal_init(void) {
+}
+
+void io_seproxyhal_general_status(void) {
+}
+
+unsigned int io_seproxyhal_spi_is_status_sent(void) {
+	return 1;
+}
+
+void io_seproxyhal_spi_send(const unsigned char * buffer, unsigned short length) {
+}
+
+unsigned short io_seproxyhal_spi_recv(unsigned char * buffer, unsigned short max_length, unsigned int flags) {
+	return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+/**
+ * cpx_replay, runs the app of the host build on a script of APDUs and button pushes, and prints the responses.
+ *
+ * each line of the script is an APDU in hex, "left", "right" or "both" to push those buttons on the displayed screen,
+ * or "tick" and an optional count of ticker events, blank lines and lines starting with # are skipped.
+ * the script runs count times, for perf and sanitizers, the responses are only printed the first time.
+ *
+ * usage: cpx_replay [-n count] [script]
+ */
+
+#include "os.h"
+#include "os_io_seproxyhal.h"
+#include "scratch.h"
+#include "host.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** max length of a line of the script, an APDU of 260 bytes in hex. */
+#define MAX_LINE_LEN 1024
+
+/** prints the response of len bytes in G_io_apdu_buffer, if there is one. */
+static void print_response(unsigned int len, bool print) {
+	if (!print || (len == 0)) {
+		return;
+	}
+	printf("<= ");
+	for (unsigned int ix = 0; ix < len; ix++) {
+		printf("%02x", G_io_apdu_buffer[ix]);
+	}
+	printf("\n");
+}
+
+/** handles the event of tag with the value, as the SDK hands it to io_event, and prints the response sent by it. */
+static void send_event(unsigned char tag, unsigned char value, bool print) {
+	G_io_seproxyhal_spi_buffer[0] = tag;
+	G_io_seproxyhal_spi_buffer[1] = 0;
+	G_io_seproxyhal_spi_buffer[2] = 1;
+	G_io_seproxyhal_spi_buffer[3] = value;
+	BEGIN_TRY
+		{
+			TRY
+				{
+					io_event(CHANNEL_SPI);
+				}
+				CATCH_OTHER(e)
+				{
+					printf("<= exception %04X\n", e);
+				}
+				FINALLY
+			{
+				scratch_reset();
+			}
+		}
+		END_TRY;
+	print_response(host_reply(), print);
+}
+
+/** sends the APDU in hex, returns false if it is not valid hex. */
+static bool send_apdu(const char * hex, bool print) {
+	unsigned int len = 0;
+	while (isxdigit((unsigned char) hex[0]) && isxdigit((unsigned char) hex[1])) {
+		if (len == sizeof(G_io_apdu_buffer)) {
+			return false;
+		}
+		unsigned int byte;
+		sscanf(hex, "%2x", &byte);
+		G_io_apdu_buffer[len++] = byte;
+		hex += 2;
+	}
+	if ((*hex != '\0') || (len == 0)) {
+		return false;
+	}
+	print_response(host_apdu(len), print);
+	return true;
+}
+
+/** runs the line of the script, returns false if it is not valid. */
+static bool run_line(char * line, bool print) {
+	char * command = strtok(line, " \t\r\n");
+	if ((command == NULL) || (command[0] == '#')) {
+		return true;
+	}
+	if (strcmp(command, "left") == 0) {
+		send_event(SEPROXYHAL_TAG_BUTTON_PUSH_EVENT, BUTTON_LEFT << 1, print);
+	} else if (strcmp(command, "right") == 0) {
+		send_event(SEPROXYHAL_TAG_BUTTON_PUSH_EVENT, BUTTON_RIGHT << 1, print);
+	} else if (strcmp(command, "both") == 0) {
+		send_event(SEPROXYHAL_TAG_BUTTON_PUSH_EVENT, (BUTTON_LEFT | BUTTON_RIGHT) << 1, print);
+	} else if (strcmp(command, "tick") == 0) {
+		const char * count = strtok(NULL, " \t\r\n");
+		for (int ix = (count == NULL) ? 1 : atoi(count); ix > 0; ix--) {
+			send_event(SEPROXYHAL_TAG_TICKER_EVENT, 0, print);
+		}
+	} else {
+		if (print) {
+			printf("=> %s\n", command);
+		}
+		return send_apdu(command, print);
+	}
+	return true;
+}
+
+/** reads the whole script, so it can run more than once from stdin. returns it as a string, NULL if it could not be read. */
+static char * read_script(FILE * file) {
+	size_t len = 0;
+	size_t size = MAX_LINE_LEN;
+	char * script = malloc(size);
+	while (script != NULL) {
+		len += fread(script + len, 1, size - len - 1, file);
+		if (len < size - 1) {
+			break;
+		}
+		size *= 2;
+		char * larger = realloc(script, size);
+		if (larger == NULL) {
+			free(script);
+		}
+		script = larger;
+	}
+	if ((script == NULL) || ferror(file)) {
+		free(script);
+		return NULL;
+	}
+	script[len] = '\0';
+	return script;
+}
+
+int main(int argc, char ** argv) {
+	unsigned long count = 1;
+	int arg = 1;
+	if ((argc > 2) && (strcmp(argv[1], "-n") == 0)) {
+		count = strtoul(argv[2], NULL, 10);
+		arg = 3;
+	}
+	if (argc > arg + 1) {
+		fprintf(stderr, "usage: cpx_replay [-n count] [script]\n");
+		return 2;
+	}
+	FILE * file = (argc > arg) ? fopen(argv[arg], "r") : stdin;
+	char * script = (file != NULL) ? read_script(file) : NULL;
+	if (script == NULL) {
+		perror((argc > arg) ? argv[arg] : "stdin");
+		return 2;
+	}
+
+	host_init();
+	char line[MAX_LINE_LEN];
+	for (unsigned long run = 0; run < count; run++) {
+		unsigned int line_number = 0;
+		for (const char * next = script; *next != '\0'; ) {
+			const char * end = strchr(next, '\n');
+			const size_t len = (end != NULL) ? (size_t) (end - next) : strlen(next);
+			line_number++;
+			if (len >= sizeof(line)) {
+				fprintf(stderr, "line %u: longer than %u characters\n", line_number, MAX_LINE_LEN - 1);
+				return 1;
+			}
+			os_memmove(line, next, len);
+			line[len] = '\0';
+			if (!run_line(line, run == 0)) {
+				fprintf(stderr, "line %u: not an APDU in hex, a button or a tick\n", line_number);
+				return 1;
+			}
+			next += (end != NULL) ? len + 1 : len;
+		}
+	}
+	free(script);
+	return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+/**
+ * the key derivation of the OS, for the host build, make host, from the fixed test mnemonic of the README,
+ * so the keys and signatures are the ones of the examples there. never use it with a mnemonic that holds funds.
+ */
+
+#include "os.h"
+#include "cx.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/obj_mac.h>
+
+/** the test mnemonic of the README. */
+#define TEST_MNEMONIC "online ramp onion faculty trap clerk near rabbit busy gravity prize employ exit horse found slogan effort dash siren buzz sport pig coconut element"
+
+/** the BIP39 seed of the mnemonic is PBKDF2-HMAC-SHA512, with 2048 iterations and "mnemonic" as the salt. */
+#define BIP39_SALT "mnemonic"
+#define BIP39_ITERATIONS 2048
+
+/** the key of the HMAC of the master node of P-256, from SLIP-10. */
+#define SLIP10_CURVE_KEY "Nist256p1 seed"
+
+/** the bit of a hardened index of a path. */
+#define HARDENED 0x80000000
+
+/** length of a private key and of a chain code. */
+#define NODE_PART_LEN 32
+
+/** the BIP39 seed, derived from the mnemonic once. */
+static unsigned char seed[64];
+
+/** true once seed is derived. */
+static bool seed_ready;
+
+/** aborts on a failed OpenSSL call, they only fail on bad arguments or no memory. */
+static void check(int ok) {
+	if (!ok) {
+		fprintf(stderr, "OpenSSL call failed\n");
+		abort();
+	}
+}
+
+static void hmac_sha512(const void * key, unsigned int key_len, const unsigned char * data, unsigned int data_len, unsigned char * mac) {
+	unsigned int mac_len = 64;
+	check(HMAC(EVP_sha512(), key, key_len, data, data_len, mac, &mac_len) != NULL);
+}
+
+/** sets key to key + the first half of i mod the order, returns false if that half is not below the order or the sum is zero. */
+static bool add_tweak(const BIGNUM * order, const unsigned char * i, unsigned char * key, BN_CTX * ctx) {
+	BIGNUM * tweak = BN_bin2bn(i, NODE_PART_LEN, NULL);
+	BIGNUM * sum = BN_bin2bn(key, NODE_PART_LEN, NULL);
+	check((tweak != NULL) && (sum != NULL));
+	bool ok = BN_cmp(tweak, order) < 0;
+	if (ok) {
+		check(BN_mod_add(sum, sum, tweak, order, ctx));
+		ok = !BN_is_zero(sum);
+	}
+	if (ok) {
+		check(BN_bn2binpad(sum, key, NODE_PART_LEN) == NODE_PART_LEN);
+	}
+	BN_clear_free(sum);
+	BN_clear_free(tweak);
+	return ok;
+}
+
+/** writes the compressed public key of the private key, for a normal child. */
+static void compressed_public_key(const EC_GROUP * curve, const unsigned char * key, unsigned char * out, BN_CTX * ctx) {
+	BIGNUM * d = BN_bin2bn(key, NODE_PART_LEN, NULL);
+	EC_POINT * w = EC_POINT_new(curve);
+	check((d != NULL) && (w != NULL));
+	check(EC_POINT_mul(curve, w, d, NULL, NULL, ctx));
+	check(EC_POINT_point2oct(curve, w, POINT_CONVERSION_COMPRESSED, out, 33, ctx) == 33);
+	EC_POINT_free(w);
+	BN_clear_free(d);
+}
+
+/** derives the node of the path from the test seed, as in SLIP-10 for P-256, the way the device derives it. */
+void os_perso_derive_node_bip32(int curve_id, const unsigned int * path, unsigned int path_len, unsigned char * private_key, unsigned char * chain) {
+	if (curve_id != CX_CURVE_256R1) {
+		THROW(INVALID_PARAMETER);
+	}
+	if (!seed_ready) {
+		check(PKCS5_PBKDF2_HMAC(TEST_MNEMONIC, strlen(TEST_MNEMONIC), (const unsigned char *) BIP39_SALT, strlen(BIP39_SALT),
+				BIP39_ITERATIONS, EVP_sha512(), sizeof(seed), seed));
+		seed_ready = true;
+	}
+	EC_GROUP * curve = EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1);
+	BN_CTX * ctx = BN_CTX_new();
+	check((curve != NULL) && (ctx != NULL));
+	const BIGNUM * order = EC_GROUP_get0_order(curve);
+
+	// the key is the first half of i, the chain code the second half.
+	unsigned char i[64];
+	unsigned char key[NODE_PART_LEN];
+	hmac_sha512(SLIP10_CURVE_KEY, strlen(SLIP10_CURVE_KEY), seed, sizeof(seed), i);
+	os_memset(key, 0, sizeof(key));
+	while (!add_tweak(order, i, key, ctx)) {
+		hmac_sha512(SLIP10_CURVE_KEY, strlen(SLIP10_CURVE_KEY), i, sizeof(i), i);
+	}
+
+	for (unsigned int level = 0; level < path_len; level++) {
+		const unsigned int index = path[level];
+		// 0x00 and the private key for a hardened child, the compressed public key for a normal one, then the index.
+		unsigned char data[1 + NODE_PART_LEN + 4];
+		if (index & HARDENED) {
+			data[0] = 0x00;
+			os_memmove(data + 1, key, NODE_PART_LEN);
+		} else {
+			compressed_public_key(curve, key, data, ctx);
+		}
+		data[33] = index >> 24;
+		data[34] = index >> 16;
+		data[35] = index >> 8;
+		data[36] = index;
+		unsigned char chain_code[NODE_PART_LEN];
+		os_memmove(chain_code, i + NODE_PART_LEN, NODE_PART_LEN);
+		hmac_sha512(chain_code, NODE_PART_LEN, data, sizeof(data), i);
+		// an invalid child is derived again from 0x01 and the second half of i, instead of the key.
+		while (!add_tweak(order, i, key, ctx)) {
+			data[0] = 0x01;
+			os_memmove(data + 1, i + NODE_PART_LEN, NODE_PART_LEN);
+			hmac_sha512(chain_code, NODE_PART_LEN, data, sizeof(data), i);
+		}
+		OPENSSL_cleanse(data, sizeof(data));
+	}
+
+	if (private_key != NULL) {
+		os_memmove(private_key, key, NODE_PART_LEN);
+	}
+	if (chain != NULL) {
+		os_memmove(chain, i + NODE_PART_LEN, NODE_PART_LEN);
+	}
+	OPENSSL_cleanse(key, sizeof(key));
+	OPENSSL_cleanse(i, sizeof(i));
+	BN_CTX_free(ctx);
+	EC_GROUP_free(curve);
+}
@@ -0,0 +1,64 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef STUB_BAGL_H
+#define STUB_BAGL_H
+
+/** the part of bagl.h of the BOLOS SDK that the screens of ui.c use, Nano S. */
+
+typedef struct {
+	unsigned char type;
+	unsigned char userid;
+	short x;
+	short y;
+	unsigned short width;
+	unsigned short height;
+	unsigned char stroke;
+	unsigned char radius;
+	unsigned char fill;
+	unsigned int fgcolor;
+	unsigned int bgcolor;
+	unsigned short font_id;
+	unsigned char icon_id;
+} bagl_component_t;
+
+typedef struct bagl_element_e bagl_element_t;
+
+/** called on a touch of the element, returns the element to redraw, or NULL. */
+typedef const bagl_element_t * (*bagl_element_callback_t)(const bagl_element_t * element);
+
+/** an element of a screen. */
+struct bagl_element_e {
+	bagl_component_t component;
+	const char * text;
+	unsigned char touch_area_brim;
+	int overfgcolor;
+	int overbgcolor;
+	bagl_element_callback_t tap;
+	bagl_element_callback_t out;
+	bagl_element_callback_t over;
+};
+
+/** the types of element. */
+#define BAGL_RECTANGLE 1
+#define BAGL_ICON 5
+#define BAGL_LABELINE 7
+
+/** the rectangle is filled. */
+#define BAGL_FILL 1
+
+/** the fonts and their alignment. */
+#define BAGL_FONT_OPEN_SANS_EXTRABOLD_11px 8
+#define BAGL_FONT_OPEN_SANS_LIGHT_14px 9
+#define BAGL_FONT_OPEN_SANS_REGULAR_11px 10
+#define BAGL_FONT_ALIGNMENT_MIDDLE 0x4000
+#define BAGL_FONT_ALIGNMENT_CENTER 0x8000
+
+/** the icons. */
+#define BAGL_GLYPH_ICON_CHECK 6
+#define BAGL_GLYPH_ICON_CROSS 7
+#define BAGL_GLYPH_ICON_DOWN 8
+#define BAGL_GLYPH_ICON_UP 9
+#define BAGL_GLYPH_ICON_EYE_BADGE 22
+
+#endif // STUB_BAGL_H
@@ -0,0 +1,85 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef STUB_CX_H
+#define STUB_CX_H
+
+/** the part of cx.h of the BOLOS SDK the app core uses, the crypto calls are only declared. */
+
+#include "os.h"
+
+/** the curve of the keys of the app. */
+#define CX_CURVE_256R1 0x21
+
+/** hash the input as the last part, and write the hash. */
+#define CX_LAST (1 << 0)
+
+/** sign with a nonce derived as in RFC 6979. */
+#define CX_RND_RFC6979 (3 << 9)
+
+/** the hash signed is a SHA-256. */
+#define CX_SHA256 3
+
+/** the common start of the context of each hash. */
+typedef struct {
+	int algo;
+	unsigned int counter;
+} cx_hash_t;
+
+/** the context of a SHA-256 hash. */
+typedef struct {
+	cx_hash_t header;
+	unsigned int blen;
+	unsigned char block[64];
+	unsigned char acc[32];
+} cx_sha256_t;
+
+/** the context of a RIPEMD-160 hash. */
+typedef struct {
+	cx_hash_t header;
+	unsigned int blen;
+	unsigned char block[64];
+	unsigned char acc[20];
+} cx_ripemd160_t;
+
+/** a public key, W is uncompressed, 0x04 followed by x and y. */
+typedef struct {
+	int curve;
+	unsigned int W_len;
+	unsigned char W[65];
+} cx_ecfp_public_key_t;
+
+/** a private key. */
+typedef struct {
+	int curve;
+	unsigned int d_len;
+	unsigned char d[32];
+} cx_ecfp_private_key_t;
+
+int cx_sha256_init(cx_sha256_t * hash);
+
+int cx_ripemd160_init(cx_ripemd160_t * hash);
+
+int cx_hash(cx_hash_t * hash, int mode, const unsigned char * in, unsigned int len, unsigned char * out, unsigned int out_len);
+
+int cx_hmac_sha512(const unsigned char * key, unsigned int key_len, const unsigned char * in, unsigned int len, unsigned char * mac, unsigned int mac_len);
+
+int cx_ecdsa_init_private_key(int curve, const unsigned char * raw_key, unsigned int key_len, cx_ecfp_private_key_t * private_key);
+
+int cx_ecdsa_init_public_key(int curve, const unsigned char * raw_key, unsigned int key_len, cx_ecfp_public_key_t * public_key);
+
+int cx_ecfp_generate_pair(int curve, cx_ecfp_public_key_t * public_key, cx_ecfp_private_key_t * private_key, int keep_private);
+
+int cx_ecdsa_sign(const cx_ecfp_private_key_t * private_key, int mode, int hash_id, const unsigned char * hash, unsigned int hash_len,
+		unsigned char * sig, unsigned int sig_len, unsigned int * info);
+
+/** r = (a + b) mod m, on big endian numbers of len bytes. */
+void cx_math_addm(unsigned char * r, const unsigned char * a, const unsigned char * b, const unsigned char * m, unsigned int len);
+
+/** compares big endian numbers of len bytes, as memcmp. */
+int cx_math_cmp(const unsigned char * a, const unsigned char * b, unsigned int len);
+
+/** returns true if the big endian number of len bytes is zero. */
+int cx_math_is_zero(const unsigned char * a, unsigned int len);
+
+#endif // STUB_CX_H
@@ -0,0 +1,9 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef STUB_GLYPHS_H
+#define STUB_GLYPHS_H
+
+/** the glyphs the SDK generates from glyphs/, the screens of the Nano S only use the icons of bagl.h. */
+
+#endif // STUB_GLYPHS_H
@@ -0,0 +1,25 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef STUB_HOST_H
+#define STUB_HOST_H
+
+/**
+ * the entry points of the host build, make host, in place of the event loop of the device.
+ * the events of the device, button pushes and ticks, go to io_event with the event in G_io_seproxyhal_spi_buffer.
+ */
+
+/** starts the app as main does, on the idle screen. */
+void host_init(void);
+
+/**
+ * handles the APDU of apdu_len bytes in G_io_apdu_buffer, as the event loop of main.c does.
+ * returns the length of the response in G_io_apdu_buffer, its status word last,
+ * or 0 if the response is sent once the user approves or denies, or the app was asked to exit.
+ */
+unsigned int host_apdu(unsigned int apdu_len);
+
+/** returns the length of the response in G_io_apdu_buffer sent since the last call, by an approve or deny, 0 if none was. */
+unsigned int host_reply(void);
+
+#endif // STUB_HOST_H
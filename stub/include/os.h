@@ -0,0 +1,130 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef STUB_OS_H
+#define STUB_OS_H
+
+/**
+ * the part of os.h of the BOLOS SDK the app core uses, to build it outside of the SDK.
+ * the system calls are only declared, each build that uses these headers provides them.
+ */
+
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/** the app runs at its link address outside of the device, so no pointer needs to be relocated. */
+#define PIC(x) ((void *) (x))
+
+/** the SDK copies memory with its own functions, the C library ones do the same. */
+#define os_memmove memmove
+#define os_memset memset
+#define os_memcmp memcmp
+
+/** an exception, the status word sent back for the APDU that raised it. */
+typedef unsigned short exception_t;
+
+/** raises the exception, it does not return. */
+void os_longjmp(unsigned int exception) __attribute__((noreturn));
+
+/** raises the exception. */
+#define THROW(x) os_longjmp(x)
+
+/** the exception of an invalid argument to a system call. */
+#define INVALID_PARAMETER 2
+
+/** an open TRY, os_longjmp jumps back to the innermost one, as in the SDK. */
+typedef struct try_context_s try_context_t;
+
+struct try_context_s {
+	jmp_buf jmp_buf;
+	try_context_t * previous;
+	exception_t ex;
+};
+
+/** returns the innermost open TRY, NULL if there is none. */
+try_context_t * try_context_get(void);
+
+/** sets the innermost open TRY, returns the one it replaces. */
+try_context_t * try_context_set(try_context_t * context);
+
+/*
+ * the TRY blocks of the SDK, on setjmp. an exception not caught is raised again in the enclosing TRY, after FINALLY.
+ * locals written in TRY and read after an exception must be volatile, as on the device.
+ */
+#define BEGIN_TRY \
+	{ \
+		try_context_t __try_context; \
+		__try_context.previous = try_context_get(); \
+		try_context_set(&__try_context); \
+		__try_context.ex = setjmp(__try_context.jmp_buf);
+
+#define TRY \
+		if (__try_context.ex == 0) {
+
+#define CATCH(x) \
+			goto __FINALLY; \
+		} else if (__try_context.ex == (x)) { \
+			__try_context.ex = 0; \
+			CLOSE_TRY;
+
+#define CATCH_OTHER(e) \
+			goto __FINALLY; \
+		} else { \
+			exception_t e = __try_context.ex; \
+			__try_context.ex = 0; \
+			CLOSE_TRY;
+
+#define FINALLY \
+			goto __FINALLY; \
+		} \
+		__FINALLY: \
+		if (try_context_get() == &__try_context) { \
+			CLOSE_TRY; \
+		}
+
+#define END_TRY \
+		if (__try_context.ex != 0) { \
+			THROW(__try_context.ex); \
+		} \
+	}
+
+#define CLOSE_TRY try_context_set(__try_context.previous)
+
+/** writes len bytes of src to dst, which is in NVRAM. */
+void nvm_write(void * dst, void * src, unsigned int len);
+
+/** derives the node of the BIP32 path from the seed of the device. */
+void os_perso_derive_node_bip32(int curve, const unsigned int * path, unsigned int path_len, unsigned char * private_key, unsigned char * chain);
+
+/** goes back to the dashboard, it does not return. */
+void os_sched_exit(unsigned int exit_code) __attribute__((noreturn));
+
+/** the screen of the device is larger than the 128x32 one of the Nano S. */
+#define SEPROXYHAL_TAG_SESSION_START_EVENT_FEATURE_SCREEN_BIG 0x0001
+
+/** the device has bluetooth. */
+#define SEPROXYHAL_TAG_SESSION_START_EVENT_FEATURE_BLE 0x0002
+
+/** returns the SEPROXYHAL_TAG_SESSION_START_EVENT_FEATURE_* flags of the device. */
+unsigned int os_seph_features(void);
+
+/** resets the device. */
+void reset(void);
+
+/** the channels and flags of io_exchange. */
+#define CHANNEL_APDU 0
+#define CHANNEL_KEYBOARD 1
+#define CHANNEL_SPI 2
+#define IO_RESET_AFTER_REPLIED 0x80
+#define IO_RECEIVE_DATA 0x40
+#define IO_RETURN_AFTER_TX 0x20
+#define IO_ASYNCH_REPLY 0x10
+#define IO_FLAGS 0xF0
+
+/** sends the tx_len bytes of the response in G_io_apdu_buffer, and unless IO_RETURN_AFTER_TX, waits for the next APDU. */
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len);
+
+#endif // STUB_OS_H
@@ -0,0 +1,116 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+#ifndef STUB_OS_IO_SEPROXYHAL_H
+#define STUB_OS_IO_SEPROXYHAL_H
+
+/**
+ * the part of os_io_seproxyhal.h of the BOLOS SDK that the event loop and the screens of the app use, Nano S.
+ * a screen is drawn at once, by sending each of its elements through its preprocessor to io_seproxyhal_display.
+ */
+
+#include "os.h"
+#include "bagl.h"
+
+/** handles the buttons of the displayed screen. */
+typedef unsigned int (*button_push_callback_t)(unsigned int button_mask, unsigned int button_mask_counter);
+
+/** the displayed screen. */
+typedef struct {
+	const bagl_element_t * elements;
+	unsigned short elements_count;
+	unsigned short elements_current;
+	bagl_element_callback_t elements_preprocessor;
+	button_push_callback_t button_push_handler;
+} ux_state_t;
+
+/** the displayed screen, defined by ui.c. */
+extern ux_state_t ux;
+
+/** the buffer of the APDU being handled, and of its response. */
+extern unsigned char G_io_apdu_buffer[260];
+
+/** the buffer of the event being handled, defined by main.c. */
+extern unsigned char G_io_seproxyhal_spi_buffer[];
+
+/** the buttons, a push sends the mask of the buttons released. */
+#define BUTTON_LEFT 1
+#define BUTTON_RIGHT 2
+#define BUTTON_EVT_RELEASED 0x80000000
+
+/** the tags of the events, in G_io_seproxyhal_spi_buffer[0]. */
+#define SEPROXYHAL_TAG_BUTTON_PUSH_EVENT 0x05
+#define SEPROXYHAL_TAG_FINGER_EVENT 0x0C
+#define SEPROXYHAL_TAG_DISPLAY_PROCESSED_EVENT 0x0D
+#define SEPROXYHAL_TAG_TICKER_EVENT 0x0E
+
+/** draws the element, defined by main.c. */
+void io_seproxyhal_display(const bagl_element_t * element);
+
+/** draws the element as the SDK does. */
+void io_seproxyhal_display_default(bagl_element_t * element);
+
+/** handles the event in G_io_seproxyhal_spi_buffer, defined by main.c. */
+unsigned char io_event(unsigned char channel);
+
+void io_seproxyhal_init(void);
+
+void io_seproxyhal_general_status(void);
+
+unsigned int io_seproxyhal_spi_is_status_sent(void);
+
+void io_seproxyhal_spi_send(const unsigned char * buffer, unsigned short length);
+
+unsigned short io_seproxyhal_spi_recv(unsigned char * buffer, unsigned short max_length, unsigned int flags);
+
+#define UX_INIT() \
+	do { \
+		os_memset(&ux, 0, sizeof(ux)); \
+	} while (0)
+
+/** sends the elements of the displayed screen that its preprocessor keeps. */
+#define UX_REDISPLAY() \
+	do { \
+		for (ux.elements_current = 0; ux.elements_current < ux.elements_count; ux.elements_current++) { \
+			const bagl_element_t * element = &ux.elements[ux.elements_current]; \
+			if ((ux.elements_preprocessor == NULL) || ((element = ux.elements_preprocessor(element)) != NULL)) { \
+				io_seproxyhal_display(element); \
+			} \
+		} \
+	} while (0)
+
+/** displays the screen of elements_array, its buttons are handled by elements_array ## _button. */
+#define UX_DISPLAY(elements_array, preprocessor) \
+	do { \
+		ux.elements = elements_array; \
+		ux.elements_count = sizeof(elements_array) / sizeof(elements_array[0]); \
+		ux.button_push_handler = elements_array ## _button; \
+		ux.elements_preprocessor = preprocessor; \
+		UX_REDISPLAY(); \
+	} while (0)
+
+/** true once every element of the displayed screen was sent. */
+#define UX_DISPLAYED() (ux.elements_current >= ux.elements_count)
+
+/** the screen is drawn at once, there is no next element to send. */
+#define UX_DISPLAYED_EVENT() \
+	do { \
+	} while (0)
+
+#define UX_BUTTON_PUSH_EVENT(seph_packet) \
+	do { \
+		if (ux.button_push_handler != NULL) { \
+			ux.button_push_handler(BUTTON_EVT_RELEASED | ((seph_packet)[3] >> 1), 0); \
+		} \
+	} while (0)
+
+/** the Nano S has no touch screen. */
+#define UX_FINGER_EVENT(seph_packet) \
+	do { \
+	} while (0)
+
+#define UX_DEFAULT_EVENT() \
+	do { \
+	} while (0)
+
+#endif // STUB_OS_IO_SEPROXYHAL_H
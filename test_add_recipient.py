@@ -0,0 +1,21 @@
+#!/usr/bin/env python
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+# script hash of the recipient (20 bytes), followed by its label (1 to 10 printable characters).
+scriptHash = "f753e908bde2dea0dc378cb39995f058d17682ce"
+label = "Exchange"
+
+body = bytearray.fromhex(scriptHash) + label.encode("ascii")
+
+dongle = getDongle(True)
+try:
+    # confirm the recipient on the device.
+    dongle.exchange(bytes(bytearray.fromhex("80140000" + "{:02X}".format(len(body)))) + bytes(body))
+    print("added " + scriptHash.upper() + " as " + label)
+except CommException as comm:
+    if comm.sw == 0x6985:
+        print("Aborted by user")
+    else:
+        print("Invalid status " + hex(comm.sw))
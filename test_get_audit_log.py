@@ -0,0 +1,27 @@
+#!/usr/bin/env python
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+# counter (4 bytes), transaction hash (32), recipient script hash (20), value (32), big endian.
+record_len = 4 + 32 + 20 + 32
+
+dongle = getDongle(True)
+page = 0
+try:
+    while True:
+        response = dongle.exchange(
+            bytes(bytearray.fromhex("8012" + "{:02X}".format(page) + "00" + "00")))
+        count = response[0]
+        for i in range(count):
+            record = response[1 + i * record_len: 1 + (i + 1) * record_len]
+            print("#" + str(int.from_bytes(record[0:4], "big"))
+                  + "  tx " + record[4:36].hex().upper()
+                  + "  to " + record[36:56].hex().upper()
+                  + "  value " + str(int.from_bytes(record[56:88], "big")))
+        # a page that is not full is the last one.
+        if count < 2:
+            break
+        page += 1
+except CommException as comm:
+    print("Invalid status " + hex(comm.sw))
@@ -0,0 +1,24 @@
+#!/usr/bin/env python
+
+import sys
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+# in the order of the counts in the response.
+names = ["display_tx_desc", "to_address", "encode_base_x", "tostring256", "divmod256",
+         "divmod256_small", "os_perso_derive_node_bip32", "cx_ecdsa_sign"]
+
+# with --reset, the counts start again from zero once read.
+p1 = "01" if "--reset" in sys.argv else "00"
+
+dongle = getDongle(True)
+try:
+    response = dongle.exchange(bytes(bytearray.fromhex("8016" + p1 + "00" + "00")))
+    count = response[0]
+    for i in range(count):
+        calls = int.from_bytes(response[1 + i * 4: 5 + i * 4], "big")
+        name = names[i] if i < len(names) else "#" + str(i)
+        print("{:>10}  {}".format(calls, name))
+except CommException as comm:
+    print("Invalid status " + hex(comm.sw))
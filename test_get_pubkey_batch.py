@@ -0,0 +1,32 @@
+#!/usr/bin/env python
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+# base path m/44'/888'/0'/0, the last element is the start index.
+bipp44_path = (
+    "8000002C"
+    + "80000378"
+    + "80000000"
+    + "00000000"
+    + "00000000")
+
+count = 20
+
+# P2 = 0x00 returns compressed public keys, P2 = 0x01 returns script hashes.
+p2 = "01"
+entry_len = 20
+
+dongle = getDongle(True)
+start = 0
+while count > 0:
+    path = bipp44_path[:32] + "{:08X}".format(start)
+    response = dongle.exchange(
+        bytes(bytearray.fromhex("8006" + "00" + p2 + "15" + path + "{:02X}".format(count))))
+    returned = response[0]
+    for i in range(returned):
+        entry = response[1 + i * entry_len: 1 + (i + 1) * entry_len]
+        print("index " + str(start + i) + "  [" + str(len(entry)) +
+              "] " + entry.hex().upper())
+    start += returned
+    count -= returned
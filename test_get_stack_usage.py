@@ -0,0 +1,16 @@
+#!/usr/bin/env python
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+dongle = getDongle(True)
+try:
+    response = dongle.exchange(bytes(bytearray.fromhex("80180000" + "00")))
+    size = int.from_bytes(response[0:4], "big")
+    deepest = int.from_bytes(response[4:8], "big")
+    free = int.from_bytes(response[8:12], "big")
+    print("stack size      " + str(size) + " bytes")
+    print("deepest used    " + str(deepest) + " bytes, " + str(size - deepest) + " bytes to spare")
+    print("free right now  " + str(free) + " bytes")
+except CommException as comm:
+    print("Invalid status " + hex(comm.sw))
@@ -0,0 +1,60 @@
+#!/usr/bin/env python
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+# the events of trace.h, and the states of UI_STATE in ui.h.
+events = {1: "apdu", 2: "chunk", 3: "parse", 4: "ui", 5: "sign"}
+ui_states = ["INIT", "IDLE", "TOP_SIGN", "TX_DESC", "SIGN", "DENY", "PUBLIC_KEY_1", "PUBLIC_KEY_2",
+             "EXPORT_PUBLIC_KEY"]
+review_types = ["tx", "batch", "policy", "message", "recipient"]
+
+# there is one tick every 100 ms.
+tick_seconds = 0.1
+
+# tick (4 bytes), event (1), payload (3), big endian.
+event_len = 8
+
+# most events sent back by a request, TRACE_DRAIN_EVENTS in trace.h.
+drain_events = 16
+
+
+def describe(event, payload):
+    if event == 1:
+        return "INS %02X P1 %02X P2 %02X" % (payload >> 16, (payload >> 8) & 0xFF, payload & 0xFF)
+    if event == 2:
+        return "raw_tx " + str(payload) + " bytes"
+    if event == 3:
+        review_type = payload >> 16
+        name = review_types[review_type] if review_type < len(review_types) else str(review_type)
+        return name + ", " + str(payload & 0xFFFF) + " screens"
+    if event == 4:
+        return ui_states[payload] if payload < len(ui_states) else str(payload)
+    if event == 5:
+        return "signature " + str(payload) + " bytes"
+    return "%06X" % payload
+
+
+dongle = getDongle(True)
+start = None
+try:
+    while True:
+        response = dongle.exchange(bytes(bytearray.fromhex("801A0000" + "00")))
+        dropped = int.from_bytes(response[0:2], "big")
+        count = response[2]
+        if dropped:
+            print("... " + str(dropped) + " events lost, drain more often")
+        for i in range(count):
+            record = response[3 + i * event_len: 3 + (i + 1) * event_len]
+            tick = int.from_bytes(record[0:4], "big")
+            event = record[4]
+            payload = int.from_bytes(record[5:8], "big")
+            if start is None:
+                start = tick
+            print("{:8.1f}s  {:<6} {}".format((tick - start) * tick_seconds, events.get(event, str(event)),
+                                             describe(event, payload)))
+        # a request that doesn't send back as many as it can has emptied the ring.
+        if count < drain_events:
+            break
+except CommException as comm:
+    print("Invalid status " + hex(comm.sw))
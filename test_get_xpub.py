@@ -0,0 +1,23 @@
+#!/usr/bin/env python
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+# account level path m/44'/888'/0'
+account_path = (
+    "8000002C"
+    + "80000378"
+    + "80000000")
+
+
+dongle = getDongle(True)
+try:
+    response = dongle.exchange(
+        bytes(bytearray.fromhex("80080000" + "0C" + account_path)))
+    print("publicKey       [65] " + response[:65].hex().upper())
+    print("chainCode       [32] " + response[65:97].hex().upper())
+except CommException as comm:
+    if comm.sw == 0x6985:
+        print("Aborted by user")
+    else:
+        print("Invalid status " + hex(comm.sw))
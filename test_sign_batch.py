@@ -0,0 +1,47 @@
+#!/usr/bin/env python
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+bip44_path = (
+    "8000002C"
+    + "80000378"
+    + "80000000"
+    + "00000000"
+    + "00000000")
+
+# 1 CPX, 0.1 CPX and 100 CPX transfers
+messages = [
+    "0000000101f753e908bde2dea0dc378cb39995f058d17682ce8dc34d5f4a634db23def2e6ba35df5537a9a304f080de0b6b3a76400000000000000000001000602ba7def3000030493e0000001706e7b73c2",
+    "0000000101f753e908bde2dea0dc378cb39995f058d17682ce8dc34d5f4a634db23def2e6ba35df5537a9a304f08016345785d8a00000000000000000001000602ba7def3000030493e0000001706e7bffa1",
+    "0000000101f753e908bde2dea0dc378cb39995f058d17682ce8dc34d5f4a634db23def2e6ba35df5537a9a304f09056bc75e2d631000000000000000000001000602ba7def3000030493e0000001706e7d2fab",
+]
+
+
+def add_to_batch(dongle, textToSign):
+    offset = 0
+    while offset != len(textToSign):
+        chunk = textToSign[offset: offset + 255]
+        p1 = 0x80 if (offset + len(chunk)) == len(textToSign) else 0x00
+        response = dongle.exchange(bytes([0x80, 0x0A, p1, 0x00, len(chunk)]) + chunk)
+        offset += len(chunk)
+    return response[0]
+
+
+dongle = getDongle(True)
+try:
+    for message in messages:
+        index = add_to_batch(dongle, bytes.fromhex(message + bip44_path))
+        print("queued          #" + str(index))
+
+    # one review on the device for the whole batch.
+    count = dongle.exchange(bytes([0x80, 0x0A, 0x00, 0x01, 0x00]))[0]
+
+    for index in range(count):
+        signature = dongle.exchange(bytes([0x80, 0x0A, 0x00, 0x02, 0x01, index]))
+        print("signature #" + str(index) + "   [" + str(len(signature)) + "] " + signature.hex())
+except CommException as comm:
+    if comm.sw == 0x6985:
+        print("Aborted by user")
+    else:
+        print("Invalid status " + hex(comm.sw))
@@ -0,0 +1,36 @@
+#!/usr/bin/env python
+
+import hashlib
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+bip44_path = (
+    "8000002C"
+    + "80000378"
+    + "80000000"
+    + "00000000"
+    + "00000000")
+
+message = b"Login to example.com, nonce 8c1f2e7a. " * 20
+
+# the signed hash is the SHA-256 of the magic followed by the SHA-256 of the message.
+signed_hash = hashlib.sha256(b"CPX Signed Message:\n" + hashlib.sha256(message).digest()).digest()
+print("message hash    [32] " + hashlib.sha256(message).hexdigest().upper())
+print("signed hash     [32] " + signed_hash.hex().upper())
+
+dongle = getDongle(True)
+try:
+    data = bytes.fromhex(bip44_path) + message
+    offset = 0
+    while offset != len(data):
+        chunk = data[offset: offset + 255]
+        p1 = 0x80 if (offset + len(chunk)) == len(data) else 0x00
+        signature = dongle.exchange(bytes([0x80, 0x0E, p1, 0x00, len(chunk)]) + chunk)
+        offset += len(chunk)
+    print("signature       [" + str(len(signature)) + "] " + signature.hex())
+except CommException as comm:
+    if comm.sw == 0x6985:
+        print("Aborted by user")
+    else:
+        print("Invalid status " + hex(comm.sw))